@@ -0,0 +1,53 @@
+# ----------------------------------------------------------------------------------------
+# Copyright (c) William Berry
+# email: wberry.cpp@gmail.com
+# github: https://github.com/wsberry
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# You may freely use this source code and its projects in compliance with the License.
+#
+# You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License src distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# About:
+#	Defines the targets of the cmd-line-parsing library. Link one of them:
+#
+#	  slx::cmd_line         the header only library:  #include <slx/cmd-line-parsing.hh>
+#	  slx::cmd_line_pch     the same headers, precompiled once for each target linking it
+#
+#	E.g.,
+#	  target_link_libraries(my-tool PRIVATE slx::cmd_line_pch)
+# -----------------------------------------------------------------------------------------
+
+# The header only library.
+#
+add_library(slx-cmd-line INTERFACE)
+add_library(slx::cmd_line ALIAS slx-cmd-line)
+target_include_directories(slx-cmd-line INTERFACE "$<BUILD_INTERFACE:${SLX_ROOT_INCLUDE_DIR}>")
+target_compile_features(slx-cmd-line INTERFACE cxx_std_20)
+
+# The precompiled headers: the library and the standard headers it includes. A target
+# linking slx::cmd_line_pch builds them once and includes them in each of its translation
+# units ahead of the source, so its sources parse none of them.
+#
+add_library(slx-cmd-line-pch INTERFACE)
+add_library(slx::cmd_line_pch ALIAS slx-cmd-line-pch)
+target_link_libraries(slx-cmd-line-pch INTERFACE slx-cmd-line)
+target_precompile_headers(slx-cmd-line-pch INTERFACE
+	<algorithm>
+	<functional>
+	<memory_resource>
+	<string>
+	<string_view>
+	<tuple>
+	<unordered_map>
+	<vector>
+	"$<BUILD_INTERFACE:${SLX_ROOT_INCLUDE_DIR}/slx/cmd-line-parsing.hh>"
+	"$<BUILD_INTERFACE:${SLX_ROOT_INCLUDE_DIR}/slx/cmd-line-schema.hh>"
+	"$<BUILD_INTERFACE:${SLX_ROOT_INCLUDE_DIR}/slx/cmd-line-views.hh>"
+)
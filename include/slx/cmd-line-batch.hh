@@ -0,0 +1,546 @@
+#pragma once
+#ifndef CMD_LINE_BATCH_HH__
+#define CMD_LINE_BATCH_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-schema.hh"
+#include "cmd-line-mapped-file.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if __has_include(<bit>)
+#   include <bit>
+#endif
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace slx {
+    namespace detail {
+        inline std::uint64_t popcount64_(const std::uint64_t word) noexcept {
+#if defined(__cpp_lib_bitops)
+            return static_cast<std::uint64_t>(std::popcount(word));
+#elif defined(_MSC_VER)
+            return static_cast<std::uint64_t>(__popcnt64(word));
+#else
+            return static_cast<std::uint64_t>(__builtin_popcountll(word));
+#endif
+        }
+    }
+
+    /**
+     * \brief Describes how the records of a batch are laid out and how many threads parse them.
+     *
+     *        By default each record is one line and the tokens (argv) of a record are separated
+     *        by NUL, i.e., the layout of /proc/<pid>/cmdline with a newline per invocation. Use
+     *        token_separator = '\n' and record_separator = '\0' for the transposed layout.
+     */
+    struct command_line_batch_config final {
+        char token_separator = '\0';
+        char record_separator = '\n';
+
+        // Zero uses std::thread::hardware_concurrency().
+        //
+        unsigned thread_count = 0;
+    };
+
+    /**
+     * \brief The values of one option across every record of a batch.
+     *
+     *        Bit 'r' of 'presence' is set when record 'r' contains the option. The values of the
+     *        present records are stored in record order as offsets/lengths into the batch buffer.
+     */
+    struct command_line_column final {
+        std::string_view name{};
+        std::vector<std::uint64_t> presence;
+        std::vector<std::uint64_t> rank;     // present records before each presence word
+        std::vector<std::uint64_t> offsets;
+        std::vector<std::uint32_t> lengths;
+
+        [[nodiscard]] bool contains(const std::size_t record) const noexcept {
+            return 0 != (presence[record >> 6] >> (record & 63) & 1u);
+        }
+
+        /**
+         * \brief The position of a present record's value in offsets/lengths.
+         */
+        [[nodiscard]] std::size_t index_of(const std::size_t record) const noexcept {
+            const auto below = presence[record >> 6] & ((std::uint64_t{1} << (record & 63)) - 1);
+            return static_cast<std::size_t>(rank[record >> 6] + detail::popcount64_(below));
+        }
+    };
+
+    /**
+     * \brief The columnar result of parse_command_line_batch. Values are views into the buffer
+     *        that was parsed, so it must outlive the result.
+     */
+    class command_line_batch final {
+    public:
+        [[nodiscard]] std::string_view buffer() const noexcept { return buffer_; }
+
+        /**
+         * \brief The number of records.
+         */
+        [[nodiscard]] std::size_t size() const noexcept { return starts_.empty() ? 0 : starts_.size() - 1; }
+
+        /**
+         * \brief The raw bytes of a record (without its separator).
+         */
+        [[nodiscard]] std::string_view record(const std::size_t r) const noexcept {
+            return buffer_.substr(starts_[r], starts_[r + 1] - 1 - starts_[r]);
+        }
+
+        /**
+         * \brief One column per option, in option order.
+         */
+        [[nodiscard]] const std::vector<command_line_column> &columns() const noexcept { return columns_; }
+        [[nodiscard]] const command_line_column &column(const std::size_t option) const noexcept { return columns_[option]; }
+
+        [[nodiscard]] bool contains(const std::size_t r, const std::size_t option) const noexcept {
+            return columns_[option].contains(r);
+        }
+
+        /**
+         * \brief The value of an option in a record (an empty view when it is absent or a flag).
+         */
+        [[nodiscard]] std::string_view value(const std::size_t r, const std::size_t option) const noexcept {
+            const auto &c = columns_[option];
+            if (!c.contains(r)) return {};
+            const auto i = c.index_of(r);
+            return buffer_.substr(c.offsets[i], c.lengths[i]);
+        }
+
+        /**
+         * \brief True when the record is missing at least one required option.
+         */
+        [[nodiscard]] bool is_incomplete(const std::size_t r) const noexcept {
+            return 0 != (incomplete_[r >> 6] >> (r & 63) & 1u);
+        }
+
+    private:
+        template<typename OptionTable>
+        friend command_line_batch parse_command_line_batch_(const OptionTable &, std::string_view,
+                                                            const command_line_batch_config &);
+
+        std::string_view buffer_{};
+        std::vector<std::size_t> starts_;        // record starts plus one past the last separator
+        std::vector<std::uint64_t> incomplete_;
+        std::vector<command_line_column> columns_;
+    };
+
+    namespace detail {
+        /**
+         * \brief Matches tokens against a command_line_options_t through hash maps built once for
+         *        the whole batch instead of scanning the options for every token.
+         */
+        class hashed_option_table_ final {
+        public:
+            explicit hashed_option_table_(const command_line_options_t &options) : options_(options) {
+                for (std::size_t i = 0; i < options.size(); ++i) {
+                    if (!std::get<0>(options[i]).empty()) long_names_.try_emplace(std::get<0>(options[i]), i);
+                    if (!std::get<1>(options[i]).empty()) short_names_.try_emplace(std::get<1>(options[i]), i);
+                }
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return options_.size(); }
+            [[nodiscard]] std::string_view long_name(const std::size_t index) const noexcept { return std::get<0>(options_[index]); }
+            [[nodiscard]] bool is_required(const std::size_t index) const noexcept { return std::get<2>(options_[index]); }
+
+            [[nodiscard]] std::size_t match(const std::string_view token) const noexcept {
+                if (token.size() < 2 || '-' != token[0]) return npos_option;
+                const auto is_long = '-' == token[1];
+                const auto &names = is_long ? long_names_ : short_names_;
+                const auto it = names.find(token.substr(is_long ? 2 : 1));
+                return it != names.end() ? it->second : npos_option;
+            }
+
+        private:
+            const command_line_options_t &options_;
+            std::unordered_map<std::string_view, std::size_t> long_names_;
+            std::unordered_map<std::string_view, std::size_t> short_names_;
+        };
+
+        /**
+         * \brief Per worker [begin, end) task ranges packed into one atomic word (begin in the low
+         *        32 bits). A worker pops from the front of its own range; an idle worker steals
+         *        the back half of another worker's range.
+         */
+        class work_stealing_ranges_ final {
+        public:
+            work_stealing_ranges_(const std::size_t workers, const std::uint32_t tasks) : ranges_(workers) {
+                for (std::size_t w = 0; w < workers; ++w) {
+                    const auto begin = static_cast<std::uint32_t>(tasks * w / workers);
+                    const auto end = static_cast<std::uint32_t>(tasks * (w + 1) / workers);
+                    ranges_[w].value.store(pack_(begin, end), std::memory_order_relaxed);
+                }
+            }
+
+            bool next(const std::size_t worker, std::uint32_t &task) noexcept {
+                auto &own = ranges_[worker].value;
+                auto current = own.load(std::memory_order_acquire);
+                while (begin_(current) < end_(current)) {
+                    if (own.compare_exchange_weak(current, pack_(begin_(current) + 1, end_(current)),
+                                                  std::memory_order_acq_rel)) {
+                        task = begin_(current);
+                        return true;
+                    }
+                }
+
+                for (std::size_t k = 1; k < ranges_.size(); ++k) {
+                    auto &victim = ranges_[(worker + k) % ranges_.size()].value;
+                    auto stolen = victim.load(std::memory_order_acquire);
+                    while (begin_(stolen) < end_(stolen)) {
+                        const auto mid = begin_(stolen) + (end_(stolen) - begin_(stolen)) / 2;
+                        if (victim.compare_exchange_weak(stolen, pack_(begin_(stolen), mid), std::memory_order_acq_rel)) {
+                            task = mid;
+                            own.store(pack_(mid + 1, end_(stolen)), std::memory_order_release);
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+        private:
+            static constexpr std::uint64_t pack_(const std::uint32_t begin, const std::uint32_t end) noexcept {
+                return static_cast<std::uint64_t>(end) << 32 | begin;
+            }
+            static constexpr std::uint32_t begin_(const std::uint64_t range) noexcept { return static_cast<std::uint32_t>(range); }
+            static constexpr std::uint32_t end_(const std::uint64_t range) noexcept { return static_cast<std::uint32_t>(range >> 32); }
+
+            struct alignas(64) range_ final {
+                std::atomic<std::uint64_t> value{};
+            };
+            std::vector<range_> ranges_;
+        };
+
+        /**
+         * \brief The threads of one batch parse. They are started once and run every phase of
+         *        the parse; the calling thread is worker 0.
+         *
+         *        An exception thrown by a task is captured (the first one, as a
+         *        std::exception_ptr), the remaining tasks of the phase are skipped and run
+         *        rethrows it on the calling thread once every worker has stopped.
+         */
+        class batch_workers_ final {
+        public:
+            explicit batch_workers_(const std::size_t workers) : workers_(workers) {
+                threads_.reserve(workers - 1);
+                try {
+                    for (std::size_t w = 1; w < workers; ++w) threads_.emplace_back([this, w] { serve_(w); });
+                } catch (...) {
+                    stop_();
+                    throw;
+                }
+            }
+
+            ~batch_workers_() { stop_(); }
+
+            batch_workers_(const batch_workers_ &) = delete;
+            batch_workers_ &operator=(const batch_workers_ &) = delete;
+
+            [[nodiscard]] std::size_t size() const noexcept { return workers_; }
+
+            /**
+             * \brief Runs task(worker, index) for every index in [0, tasks), distributed by work
+             *        stealing, and returns when all are done.
+             * @throw The first exception thrown by a task.
+             */
+            template<typename Task>
+            void run(const std::uint32_t tasks, Task &&task) {
+                work_stealing_ranges_ ranges(workers_, tasks);
+                const auto phase = [&](const std::size_t worker) {
+                    std::uint32_t index{};
+                    while (!failed_.load(std::memory_order_relaxed) && ranges.next(worker, index)) task(worker, index);
+                };
+                {
+                    const std::lock_guard<std::mutex> lock(mutex_);
+                    phase_ = phase;
+                    running_ = threads_.size();
+                    ++generation_;
+                }
+                started_.notify_all();
+                run_phase_(0);
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                finished_.wait(lock, [&] { return 0 == running_; });
+                phase_ = nullptr;
+                failed_.store(false, std::memory_order_relaxed);
+                if (auto error = std::exchange(error_, nullptr)) std::rethrow_exception(error);
+            }
+
+        private:
+            void run_phase_(const std::size_t worker) noexcept {
+                try {
+                    phase_(worker);
+                } catch (...) {
+                    failed_.store(true, std::memory_order_relaxed);
+                    const std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) error_ = std::current_exception();
+                }
+            }
+
+            void serve_(const std::size_t worker) noexcept {
+                std::uint64_t seen = 0;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        started_.wait(lock, [&] { return stopping_ || seen != generation_; });
+                        if (stopping_) return;
+                        seen = generation_;
+                    }
+                    run_phase_(worker);
+
+                    const std::lock_guard<std::mutex> lock(mutex_);
+                    if (0 == --running_) finished_.notify_one();
+                }
+            }
+
+            void stop_() noexcept {
+                {
+                    const std::lock_guard<std::mutex> lock(mutex_);
+                    stopping_ = true;
+                }
+                started_.notify_all();
+                for (auto &t: threads_) t.join();
+            }
+
+            std::size_t workers_;
+            std::vector<std::thread> threads_;
+            std::mutex mutex_;
+            std::condition_variable started_;
+            std::condition_variable finished_;
+            std::function<void(std::size_t)> phase_;
+            std::uint64_t generation_{};
+            std::size_t running_{};
+            bool stopping_{};
+            std::atomic<bool> failed_{};
+            std::exception_ptr error_;
+        };
+
+        /**
+         * \brief A parsed option of one record; 'record' is relative to the chunk.
+         */
+        struct batch_event_ final {
+            std::uint32_t record;
+            std::uint32_t option;
+            std::uint64_t offset;
+            std::uint32_t length;
+        };
+
+        inline constexpr std::size_t batch_chunk_records_ = 1024;   // a multiple of 64 so bitmap words are never shared
+    }
+
+    /**
+     * \brief The implementation of parse_command_line_batch for any option table.
+     */
+    template<typename OptionTable>
+    command_line_batch parse_command_line_batch_(const OptionTable &options, const std::string_view buffer,
+                                                 const command_line_batch_config &config) {
+        command_line_batch result;
+        result.buffer_ = buffer;
+
+        const auto hardware = std::thread::hardware_concurrency();
+        const std::size_t workers = config.thread_count ? config.thread_count : (hardware ? hardware : 1);
+        const auto option_count = options.size();
+
+        // The workers are started once and run the four phases below.
+        //
+        detail::batch_workers_ pool(workers);
+
+        // 1. Find the record boundaries; each worker scans a slice of the buffer.
+        //
+        std::vector<std::vector<std::size_t>> separators(workers);
+        pool.run(static_cast<std::uint32_t>(workers), [&](std::size_t, const std::uint32_t slice) {
+            const auto begin = buffer.size() * slice / workers;
+            const auto end = buffer.size() * (slice + 1) / workers;
+            auto p = buffer.data() + begin;
+            const auto last = buffer.data() + end;
+            while (p < last) {
+                const auto found = static_cast<const char *>(std::memchr(p, config.record_separator, static_cast<std::size_t>(last - p)));
+                if (!found) break;
+                separators[slice].push_back(static_cast<std::size_t>(found - buffer.data()));
+                p = found + 1;
+            }
+        });
+
+        if (!buffer.empty()) {
+            result.starts_.push_back(0);
+            for (const auto &slice: separators) {
+                for (const auto s: slice) result.starts_.push_back(s + 1);
+            }
+            if (result.starts_.back() != buffer.size()) result.starts_.push_back(buffer.size() + 1);
+        }
+
+        const auto records = result.size();
+        const auto words = (records + 63) / 64;
+        const auto chunks = (records + detail::batch_chunk_records_ - 1) / detail::batch_chunk_records_;
+
+        result.incomplete_.assign(words, 0);
+        result.columns_.resize(option_count);
+        for (std::size_t c = 0; c < option_count; ++c) {
+            result.columns_[c].name = options.long_name(c);
+            result.columns_[c].presence.assign(words, 0);
+        }
+
+        // 2. Parse the records a chunk at a time. The presence bits are set directly (a chunk
+        //    owns its bitmap words); the values are collected per chunk and counted per column.
+        //
+        struct scratch_ final {
+            std::vector<std::string_view> tokens;
+            std::vector<std::uint32_t> event_of;   // the event of an option in the current record
+        };
+        std::vector<scratch_> scratch(workers);
+        std::vector<std::vector<detail::batch_event_>> events(chunks);
+        std::vector<std::uint64_t> counts(chunks * option_count, 0);
+
+        pool.run(static_cast<std::uint32_t>(chunks), [&](const std::size_t worker, const std::uint32_t chunk) {
+            auto &[tokens, event_of] = scratch[worker];
+            if (event_of.size() != option_count) event_of.assign(option_count, UINT32_MAX);
+
+            auto &chunk_events = events[chunk];
+            auto *chunk_counts = counts.data() + chunk * option_count;
+            const auto first = chunk * detail::batch_chunk_records_;
+            const auto last = std::min(records, first + detail::batch_chunk_records_);
+
+            for (auto r = first; r < last; ++r) {
+                const auto text = result.record(r);
+                tokens.clear();
+                for (std::size_t begin = 0; begin <= text.size();) {
+                    auto end = text.find(config.token_separator, begin);
+                    if (std::string_view::npos == end) end = text.size();
+                    if (end > begin || end < text.size()) tokens.push_back(text.substr(begin, end - begin));
+                    begin = end + 1;
+                }
+
+                const auto first_event = chunk_events.size();
+                detail::scan_command_line_tokens_(tokens,
+                                                  [&](const std::string_view token) { return options.match(token); },
+                                                  [&](const std::size_t option, const std::string_view value) {
+                    const auto offset = static_cast<std::uint64_t>(value.data() ? value.data() - buffer.data() : 0);
+                    if (UINT32_MAX != event_of[option]) {
+                        auto &e = chunk_events[event_of[option]];
+                        e.offset = offset;
+                        e.length = static_cast<std::uint32_t>(value.size());
+                        return;
+                    }
+                    event_of[option] = static_cast<std::uint32_t>(chunk_events.size());
+                    chunk_events.push_back({static_cast<std::uint32_t>(r - first), static_cast<std::uint32_t>(option),
+                                            offset, static_cast<std::uint32_t>(value.size())});
+                    ++chunk_counts[option];
+                    result.columns_[option].presence[r >> 6] |= std::uint64_t{1} << (r & 63);
+                });
+
+                for (std::size_t o = 0; o < option_count; ++o) {
+                    if (options.is_required(o) && UINT32_MAX == event_of[o]) {
+                        result.incomplete_[r >> 6] |= std::uint64_t{1} << (r & 63);
+                        break;
+                    }
+                }
+                for (auto e = first_event; e < chunk_events.size(); ++e) event_of[chunk_events[e].option] = UINT32_MAX;
+            }
+        });
+
+        // 3. Turn the per chunk counts into per column positions, then scatter the values.
+        //
+        for (std::size_t c = 0; c < option_count; ++c) {
+            std::uint64_t total = 0;
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                const auto n = counts[chunk * option_count + c];
+                counts[chunk * option_count + c] = total;
+                total += n;
+            }
+            result.columns_[c].offsets.resize(total);
+            result.columns_[c].lengths.resize(total);
+        }
+
+        pool.run(static_cast<std::uint32_t>(chunks), [&](std::size_t, const std::uint32_t chunk) {
+            auto *position = counts.data() + chunk * option_count;
+            for (const auto &e: events[chunk]) {
+                auto &c = result.columns_[e.option];
+                const auto i = position[e.option]++;
+                c.offsets[i] = e.offset;
+                c.lengths[i] = e.length;
+            }
+        });
+
+        pool.run(static_cast<std::uint32_t>(option_count), [&](std::size_t, const std::uint32_t option) {
+            auto &c = result.columns_[option];
+            c.rank.resize(words);
+            std::uint64_t below = 0;
+            for (std::size_t w = 0; w < words; ++w) {
+                c.rank[w] = below;
+                below += detail::popcount64_(c.presence[w]);
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * \brief Parses a buffer of recorded command lines (see command_line_batch_config for the
+     *        layout) on all cores without touching the global results.
+     *
+     *        E.g.,
+     *        slx::mapped_file log("invocations.log");
+     *        const auto batch = slx::parse_command_line_batch(options, log);
+     *        for (std::size_t r = 0; r < batch.size(); ++r)
+     *            if (batch.contains(r, 0)) std::string_view in = batch.value(r, 0);
+     *
+     *        Every record is parsed with the same rules as parse_command_line_args; the first
+     *        token of a record is the application path.
+     */
+    inline command_line_batch parse_command_line_batch(const command_line_options_t &options,
+                                                       const std::string_view records,
+                                                       const command_line_batch_config &config = {}) {
+        return parse_command_line_batch_(detail::hashed_option_table_(options), records, config);
+    }
+
+    template<std::size_t N>
+    command_line_batch parse_command_line_batch(const command_line_schema<N> &options,
+                                                const std::string_view records,
+                                                const command_line_batch_config &config = {}) {
+        return parse_command_line_batch_(options, records, config);
+    }
+
+    /**
+     * \brief Parses a mapped file of records; the file must outlive the result.
+     */
+    inline command_line_batch parse_command_line_batch(const command_line_options_t &options,
+                                                       const mapped_file &records,
+                                                       const command_line_batch_config &config = {}) {
+        return parse_command_line_batch(options, records.view(), config);
+    }
+
+    template<std::size_t N>
+    command_line_batch parse_command_line_batch(const command_line_schema<N> &options,
+                                                const mapped_file &records,
+                                                const command_line_batch_config &config = {}) {
+        return parse_command_line_batch_(options, records.view(), config);
+    }
+}
+
+#endif // CMD_LINE_BATCH_HH__
@@ -0,0 +1,187 @@
+#pragma once
+#ifndef CMD_LINE_BINDING_HH__
+#define CMD_LINE_BINDING_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-views.hh"
+
+namespace slx {
+    namespace detail {
+        /**
+         * \brief The option_type implied by the type of a bound field.
+         */
+        template<typename Field>
+        constexpr option_type option_type_of_() noexcept {
+            if constexpr (std::is_same_v<Field, bool>) return option_type::boolean;
+            else if constexpr (is_duration_<Field>::value) return option_type::duration;
+            else if constexpr (std::is_integral_v<Field>) return option_type::integer;
+            else if constexpr (std::is_floating_point_v<Field>) return option_type::floating_point;
+            else if constexpr (std::is_enum_v<Field>) return option_type::enumeration;
+            else return option_type::string;
+        }
+    }
+
+    /**
+     * \brief Binds an option to a field of a configuration struct (see bind_option).
+     */
+    template<typename Config, typename Field>
+    struct option_binding final {
+        option_spec spec{};
+        Field Config::*member{};
+    };
+
+    /**
+     * \brief Declares an option and the field of 'Config' that receives its value.
+     *
+     *        The option's type is implied by the field: bool, integral, floating point and
+     *        std::chrono::duration fields are converted (see option_type); std::string and
+     *        std::string_view fields receive the text. Pass 'type' to override it, e.g.,
+     *        option_type::byte_size for a std::size_t field. A value outside the range of an
+     *        integral field is an invalid value rather than being truncated.
+     */
+    template<typename Config, typename Field>
+        requires (!std::is_enum_v<Field>)
+    constexpr option_binding<Config, Field> bind_option(const std::string_view long_name, const std::string_view short_name,
+                                                        const bool required, Field Config::*member,
+                                                        const option_type type = detail::option_type_of_<Field>(),
+                                                        const std::string_view choices = {}) noexcept {
+        return {option_spec{long_name, short_name, required, type, choices}, member};
+    }
+
+    /**
+     * \brief Declares an enumeration option bound to an enum field. The '|' separated 'choices'
+     *        name the enumerators in order (the index of the choice is the enumerator's value).
+     *
+     *        E.g.,
+     *        enum class mode_t { fast, safe };
+     *        slx::bind_option("mode", "m", false, &config_t::mode, "fast|safe");
+     *
+     *        The choices are required: an enum field bound without them does not compile, and
+     *        empty choices are rejected (a compile error when the binding is constexpr).
+     */
+    template<typename Config, typename Field>
+        requires std::is_enum_v<Field>
+    constexpr option_binding<Config, Field> bind_option(const std::string_view long_name, const std::string_view short_name,
+                                                        const bool required, Field Config::*member,
+                                                        const std::string_view choices) {
+        if (choices.empty()) throw std::invalid_argument("bind_option: an enum field requires its choices");
+        return {option_spec{long_name, short_name, required, option_type::enumeration, choices}, member};
+    }
+
+    /**
+     * \brief A schema whose options are bound to the fields of 'Config'. The schema, the required
+     *        flags and the fields come from the same declaration.
+     *
+     *        E.g.,
+     *        struct config_t { std::string in; std::string out{"result.json"}; int threads{8}; };
+     *
+     *        constexpr auto binding = slx::make_command_line_binding(
+     *            slx::bind_option("in", "i", true, &config_t::in),
+     *            slx::bind_option("out", "o", false, &config_t::out),
+     *            slx::bind_option("threads", "j", false, &config_t::threads));
+     *
+     *        config_t config;
+     *        if (!slx::parse_command_line_args(binding, config, argc, argv, help_info)) return EXIT_FAILURE;
+     *
+     *        Fields of options that are not on the command line keep their values.
+     */
+    template<typename Config, typename... Fields>
+    class command_line_binding final {
+    public:
+        static constexpr std::size_t size = sizeof...(Fields);
+
+        constexpr explicit command_line_binding(const option_binding<Config, Fields> &...bindings)
+            : schema_(std::array<option_spec, size>{bindings.spec...}), members_(bindings.member...) {}
+
+        [[nodiscard]] constexpr const command_line_schema<size> &schema() const noexcept { return schema_; }
+
+        /**
+         * \brief Rejects the values that do not fit in their bound fields (see
+         *        command_line_views::require_fits), so that they are reported, not truncated.
+         * @return true if every value fits.
+         */
+        bool validate(command_line_views<size> &views) const noexcept {
+            return validate_(views, std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * \brief Copies the parsed values into the bound fields of 'config'.
+         */
+        void assign(const command_line_views<size> &views, Config &config) const {
+            assign_(views, config, std::index_sequence_for<Fields...>{});
+        }
+
+    private:
+        template<std::size_t... I>
+        static bool validate_(command_line_views<size> &views, std::index_sequence<I...>) noexcept {
+            return (views.template require_fits<Fields>(I) & ...);
+        }
+
+        template<std::size_t... I>
+        void assign_(const command_line_views<size> &views, Config &config, std::index_sequence<I...>) const {
+            (assign_field_(views, I, config.*std::get<I>(members_)), ...);
+        }
+
+        template<typename Field>
+        static void assign_field_(const command_line_views<size> &views, const std::size_t index, Field &field) {
+            if (!views.contains(index) || !views.is_valid(index)) return;
+
+            if constexpr (std::is_same_v<Field, std::string>) {
+                field.assign(views.value(index));
+            } else if constexpr (std::is_same_v<Field, std::string_view>) {
+                field = views.value(index);
+            } else {
+                field = views.template get<Field>(index);
+            }
+        }
+
+        command_line_schema<size> schema_;
+        std::tuple<Fields Config::*...> members_;
+    };
+
+    template<typename Config, typename... Fields>
+    constexpr command_line_binding<Config, Fields...> make_command_line_binding(const option_binding<Config, Fields> &...bindings) {
+        return command_line_binding<Config, Fields...>(bindings...);
+    }
+
+    /**
+     * \brief Parses the command line into the fields of 'config' (see command_line_binding).
+     *
+     *        Missing required options, values that cannot be converted to their field's type and
+     *        values outside the range of their field are reported together; publish_help_info is
+     *        called if there are any.
+     *
+     *        std::string_view fields view argv. The response files of a parse_mode::response_files
+     *        parse are released when it returns, so bind std::string fields with that mode. As
+     *        with parse_command_line_views, the other modes are not supported.
+     * @return true if every required option was present and every value was valid.
+     */
+    template<typename Config, typename... Fields>
+    bool parse_command_line_args(const command_line_binding<Config, Fields...> &binding, Config &config,
+                                 const int argc, char **argv, const std::function<void()> &publish_help_info,
+                                 const parse_mode mode = parse_mode::none) {
+        auto views = parse_command_line_views<false>(binding.schema(), argc, argv, nullptr, mode);
+        binding.validate(views);
+        if (views.has_errors() && publish_help_info) publish_help_info();
+        binding.assign(views, config);
+        return !views.has_errors();
+    }
+}
+
+#endif // CMD_LINE_BINDING_HH__
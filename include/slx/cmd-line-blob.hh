@@ -0,0 +1,333 @@
+#pragma once
+#ifndef CMD_LINE_BLOB_HH__
+#define CMD_LINE_BLOB_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-parsing.hh"
+#include "cmd-line-mapped-file.hh"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+namespace slx {
+    namespace detail {
+        /**
+         * \brief The layout of a command line blob (see command_line_blob):
+         *
+         *        [header][entry 0 .. entry count - 1][string pool]
+         *
+         *        Entries are sorted by key and hold offsets into the string pool, so the blob
+         *        may be mapped at any address. Integers are in the byte order of the host.
+         */
+        struct blob_header_ final {
+            std::uint32_t magic;
+            std::uint16_t version;
+            std::uint16_t reserved;
+            std::uint32_t count;
+            std::uint32_t pool_size;
+            std::uint64_t checksum; // of the entries and the string pool
+        };
+
+        struct blob_entry_ final {
+            std::uint32_t key_offset;
+            std::uint32_t key_length;
+            std::uint32_t value_offset;
+            std::uint32_t value_length;
+        };
+
+        inline constexpr std::uint32_t blob_magic_ = 0x42584c53; // "SLXB"
+        inline constexpr std::uint16_t blob_version_ = 2; // 2: the checksum is taken a word at a time
+
+        /**
+         * \brief A 64 bit checksum taken 8 bytes at a time (the tail is zero padded). Each step
+         *        (xor, odd multiply, xor shift) is a bijection of the state, so a blob that differs
+         *        in a single word always has a different checksum.
+         */
+        inline std::uint64_t blob_checksum_(const std::byte *p, const std::size_t size) noexcept {
+            constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+            auto hash = 0xcbf29ce484222325ull ^ size;
+            std::size_t i = 0;
+            for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+                std::uint64_t word;
+                std::memcpy(&word, p + i, sizeof(word));
+                hash = (hash ^ word) * multiplier;
+                hash ^= hash >> 32;
+            }
+            std::uint64_t tail = 0;
+            if (i < size) std::memcpy(&tail, p + i, size - i);
+            hash = (hash ^ tail) * multiplier;
+            return hash ^ (hash >> 29);
+        }
+    }
+
+    /**
+     * \brief The size of the blob that write_command_line_blob produces for 'results'.
+     */
+    [[nodiscard]] inline std::size_t command_line_blob_size(const command_line_options_result_t &results) noexcept {
+        auto size = sizeof(detail::blob_header_) + results.size() * sizeof(detail::blob_entry_);
+        for (const auto &[key, value]: results) size += key.size() + value.size();
+        return size;
+    }
+
+    /**
+     * \brief Serializes parse results into 'blob' (e.g., a shared memory mapping).
+     * @return The size of the blob, or 0 if 'blob' is smaller than command_line_blob_size.
+     */
+    inline std::size_t write_command_line_blob(const command_line_options_result_t &results, const std::span<std::byte> blob) {
+        const auto size = command_line_blob_size(results);
+        if (blob.size() < size || size > std::numeric_limits<std::uint32_t>::max()) return 0;
+
+        std::vector<const command_line_options_result_t::value_type *> sorted;
+        sorted.reserve(results.size());
+        for (const auto &result: results) sorted.push_back(&result);
+        std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) { return a->first < b->first; });
+
+        const auto entries = blob.data() + sizeof(detail::blob_header_);
+        const auto pool = entries + sorted.size() * sizeof(detail::blob_entry_);
+        std::uint32_t pool_size = 0;
+        const auto append = [&](const std::string &text) {
+            std::memcpy(pool + pool_size, text.data(), text.size());
+            const auto offset = pool_size;
+            pool_size += static_cast<std::uint32_t>(text.size());
+            return offset;
+        };
+
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            const auto &[key, value] = *sorted[i];
+            detail::blob_entry_ entry{};
+            entry.key_length = static_cast<std::uint32_t>(key.size());
+            entry.key_offset = append(key);
+            entry.value_length = static_cast<std::uint32_t>(value.size());
+            entry.value_offset = append(value);
+            std::memcpy(entries + i * sizeof(entry), &entry, sizeof(entry));
+        }
+
+        detail::blob_header_ header{};
+        header.magic = detail::blob_magic_;
+        header.version = detail::blob_version_;
+        header.count = static_cast<std::uint32_t>(sorted.size());
+        header.pool_size = pool_size;
+        header.checksum = detail::blob_checksum_(entries, size - sizeof(header));
+        std::memcpy(blob.data(), &header, sizeof(header));
+        return size;
+    }
+
+    /**
+     * \brief Serializes parse results into a new blob.
+     *
+     *        E.g.,
+     *        auto blob = slx::make_command_line_blob(slx::parse_command_line_args(options, argc, argv, help_info));
+     */
+    [[nodiscard]] inline std::vector<std::byte> make_command_line_blob(const command_line_options_result_t &results) {
+        std::vector<std::byte> blob(command_line_blob_size(results));
+        write_command_line_blob(results, blob);
+        return blob;
+    }
+
+#if defined(__linux__)
+    /**
+     * \brief Copies a blob into a sealed memfd that workers can map (see mapped_file::open).
+     *        The descriptor is inherited across exec unless 'close_on_exec' is set.
+     * @return The descriptor, or -1 on failure.
+     */
+    inline int make_command_line_blob_fd(const std::span<const std::byte> blob, const bool close_on_exec = false) {
+        const auto fd = ::memfd_create("slx-command-line", MFD_ALLOW_SEALING | (close_on_exec ? MFD_CLOEXEC : 0u));
+        if (fd < 0) return -1;
+
+        auto p = blob.data();
+        auto remaining = blob.size();
+        while (remaining > 0) {
+            const auto written = ::write(fd, p, remaining);
+            if (written < 0) {
+                if (EINTR == errno) continue;
+                ::close(fd);
+                return -1;
+            }
+            p += written;
+            remaining -= static_cast<std::size_t>(written);
+        }
+        ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+        return fd;
+    }
+#endif
+
+    /**
+     * \brief Parse results queried in place in a serialized blob (see make_command_line_blob),
+     *        e.g., one mapped from shared memory or a memfd by a forked or spawned worker. There
+     *        is no deserialization step: lookups binary search the blob's sorted offset table
+     *        and return views into its string pool.
+     *
+     *        E.g.,
+     *        slx::mapped_file mapping;
+     *        mapping.open(blob_fd);
+     *        const slx::command_line_blob cmd_line(mapping.view());
+     *        if (!cmd_line) return EXIT_FAILURE;
+     *        std::string_view input_file = cmd_line["in"];
+     *
+     *        The header, the bounds of every entry and a checksum of the entries and pool are
+     *        validated on construction; an invalid blob is empty. The blob must outlive this.
+     */
+    class command_line_blob final {
+    public:
+        command_line_blob() noexcept = default;
+
+        explicit command_line_blob(const std::span<const std::byte> blob) noexcept { open(blob); }
+
+        explicit command_line_blob(const std::string_view blob) noexcept {
+            open(std::as_bytes(std::span<const char>(blob.data(), blob.size())));
+        }
+
+        /**
+         * \brief Validates and attaches to 'blob'.
+         * @return false (and the results are empty) if it is not a valid blob.
+         */
+        bool open(const std::span<const std::byte> blob) noexcept {
+            entries_ = pool_ = nullptr;
+            count_ = 0;
+
+            detail::blob_header_ header{};
+            if (blob.size() < sizeof(header)) return false;
+            std::memcpy(&header, blob.data(), sizeof(header));
+            if (detail::blob_magic_ != header.magic || detail::blob_version_ != header.version) return false;
+
+            const auto payload = static_cast<std::size_t>(header.count) * sizeof(detail::blob_entry_) + header.pool_size;
+            if (blob.size() - sizeof(header) < payload) return false;
+
+            const auto entries = blob.data() + sizeof(header);
+            if (header.checksum != detail::blob_checksum_(entries, payload)) return false;
+
+            const auto pool = entries + header.count * sizeof(detail::blob_entry_);
+            for (std::uint32_t i = 0; i < header.count; ++i) {
+                detail::blob_entry_ entry{};
+                std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+                if (std::uint64_t{entry.key_offset} + entry.key_length > header.pool_size ||
+                    std::uint64_t{entry.value_offset} + entry.value_length > header.pool_size) {
+                    return false;
+                }
+            }
+
+            entries_ = entries;
+            pool_ = pool;
+            count_ = header.count;
+            return true;
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept { return nullptr != entries_; }
+        explicit operator bool() const noexcept { return is_valid(); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return count_; }
+        [[nodiscard]] bool empty() const noexcept { return 0 == count_; }
+
+        [[nodiscard]] std::string_view key(const std::size_t index) const noexcept {
+            const auto entry = entry_(index);
+            return text_(entry.key_offset, entry.key_length);
+        }
+
+        [[nodiscard]] std::string_view value(const std::size_t index) const noexcept {
+            const auto entry = entry_(index);
+            return text_(entry.value_offset, entry.value_length);
+        }
+
+        [[nodiscard]] std::size_t count(const std::string_view key) const noexcept { return npos != find(key) ? 1 : 0; }
+        [[nodiscard]] bool contains(const std::string_view key) const noexcept { return npos != find(key); }
+        [[nodiscard]] bool has_option(const std::string_view key) const noexcept { return contains(key); }
+
+        /**
+         * \brief The value of the option or an empty view when it is not present.
+         */
+        [[nodiscard]] std::string_view operator[](const std::string_view key) const noexcept {
+            const auto index = find(key);
+            return npos != index ? value(index) : std::string_view{};
+        }
+
+        [[nodiscard]] std::string_view option(const std::string_view key) const noexcept { return (*this)[key]; }
+
+        /**
+         * \brief Copies the options out of the blob (see publish_command_line_blob).
+         */
+        [[nodiscard]] command_line_options_result_t results() const {
+            command_line_options_result_t results;
+            results.reserve(count_);
+            for (std::size_t i = 0; i < count_; ++i) results.emplace(key(i), value(i));
+            return results;
+        }
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /**
+         * \brief The index of 'key' (binary search of the sorted offset table), or npos.
+         */
+        [[nodiscard]] std::size_t find(const std::string_view key) const noexcept {
+            std::size_t first = 0;
+            std::size_t last = count_;
+            while (first < last) {
+                const auto middle = first + (last - first) / 2;
+                const auto order = this->key(middle).compare(key);
+                if (0 == order) return middle;
+                if (order < 0) first = middle + 1;
+                else last = middle;
+            }
+            return npos;
+        }
+
+    private:
+        [[nodiscard]] detail::blob_entry_ entry_(const std::size_t index) const noexcept {
+            detail::blob_entry_ entry{};
+            std::memcpy(&entry, entries_ + index * sizeof(entry), sizeof(entry));
+            return entry;
+        }
+
+        [[nodiscard]] std::string_view text_(const std::uint32_t offset, const std::uint32_t length) const noexcept {
+            return {reinterpret_cast<const char *>(pool_) + offset, length};
+        }
+
+        const std::byte *entries_{};
+        const std::byte *pool_{};
+        std::size_t count_{};
+    };
+
+    /**
+     * \brief Publishes the options of a blob as the global results, so that a worker that
+     *        received its command line as a blob answers get_command_line_option,
+     *        command_line_option and command_line_snapshot() as if it had parsed it.
+     *
+     *        E.g.,
+     *        const slx::command_line_blob cmd_line(mapping.view());
+     *        if (!slx::publish_command_line_blob(cmd_line)) return EXIT_FAILURE;
+     *        auto input_file = slx::get_command_line_option("in");
+     *
+     *        The options are copied once, so the blob need not outlive the published results.
+     * @return false (and nothing is published) if the blob is not valid.
+     */
+    inline bool publish_command_line_blob(const command_line_blob &blob) {
+        if (!blob) return false;
+        publish_command_line_snapshot(blob.results());
+        return true;
+    }
+}
+
+#endif // CMD_LINE_BLOB_HH__
@@ -0,0 +1,340 @@
+#pragma once
+#ifndef CMD_LINE_COMPLETIONS_HH__
+#define CMD_LINE_COMPLETIONS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+// Opt-in: including this header in any translation unit of the program enables
+// parse_mode::abbreviations (see parse_mode).
+//
+#include "cmd-line-parsing.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace slx {
+    namespace detail {
+        /**
+         * \brief The layout of a completion index (see command_line_completions):
+         *
+         *        [header][entry 0 .. entry count - 1][name pool]
+         *
+         *        Entries are sorted by name and hold offsets into the name pool, so the index
+         *        may be mapped at any address. Integers are in the byte order of the host.
+         */
+        struct completions_header_ final {
+            std::uint32_t magic;
+            std::uint16_t version;
+            std::uint16_t reserved;
+            std::uint32_t count;
+            std::uint32_t pool_size;
+        };
+
+        struct completions_entry_ final {
+            std::uint32_t name_offset;
+            std::uint32_t name_length;
+            std::uint32_t option;
+        };
+
+        inline constexpr std::uint32_t completions_magic_ = 0x43584c53; // "SLXC"
+        inline constexpr std::uint16_t completions_version_ = 1;
+    }
+
+    /**
+     * \brief The long option names of a schema in sorted order, for resolving unambiguous prefix
+     *        abbreviations ('--enable-vec' for '--enable-vectorized-io') and for shell
+     *        completion.
+     *
+     *        Every name that starts with a prefix lies in one contiguous run of the sorted
+     *        names (the subtree of that prefix in a trie), found with two binary searches over
+     *        the names; nothing is allocated per lookup.
+     *
+     *        The index is a flat, position independent image that can be written to a file
+     *        and mapped by a completion helper, which then needs neither the application nor
+     *        its schema:
+     *
+     *        E.g.,
+     *        // When the application is built or installed:
+     *        slx::command_line_completions(options).save("tool.completions");
+     *
+     *        // In the completion helper:
+     *        slx::mapped_file mapping;
+     *        mapping.open("tool.completions");
+     *        const slx::command_line_completions completions(mapping.view());
+     *        const auto [first, last] = completions.prefix_range(word);
+     *        for (auto i = first; i < last; ++i) print("--", completions.name(i));
+     *
+     *        A mapped image is validated (header and the bounds of every entry) when it is
+     *        opened and must outlive this; an invalid image is empty.
+     */
+    class command_line_completions final {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        command_line_completions() noexcept = default;
+
+        /**
+         * \brief Builds the index of the long names of 'options' (a command_line_options_t
+         *        or a command_line_schema). Options without a long name are left out.
+         */
+        template<typename Options>
+            requires requires(const Options &o, const std::size_t i) { o.long_name(i); } ||
+                     requires(const Options &o, const std::size_t i) { std::get<0>(o[i]); }
+        explicit command_line_completions(const Options &options) {
+            if constexpr (requires { options.long_name(std::size_t{}); }) {
+                build_(options.size(), [&](const std::size_t i) { return std::string_view(options.long_name(i)); });
+            } else {
+                build_(options.size(), [&](const std::size_t i) { return std::string_view(std::get<0>(options[i])); });
+            }
+        }
+
+        explicit command_line_completions(const std::span<const std::byte> image) noexcept { open(image); }
+
+        explicit command_line_completions(const std::string_view image) noexcept {
+            open(std::as_bytes(std::span<const char>(image.data(), image.size())));
+        }
+
+        command_line_completions(const command_line_completions &other) { *this = other; }
+        command_line_completions(command_line_completions &&) noexcept = default;
+        command_line_completions &operator=(command_line_completions &&) noexcept = default;
+
+        command_line_completions &operator=(const command_line_completions &other) {
+            if (this == &other) return *this;
+            storage_ = other.storage_;
+            if (other.storage_.empty()) open(other.image());
+            else open(storage_);
+            return *this;
+        }
+
+        /**
+         * \brief Validates and attaches to a serialized index (see image).
+         * @return false (and the index is empty) if it is not a valid index.
+         */
+        bool open(const std::span<const std::byte> image) noexcept {
+            entries_ = pool_ = nullptr;
+            count_ = size_ = 0;
+
+            detail::completions_header_ header{};
+            if (image.size() < sizeof(header)) return false;
+            std::memcpy(&header, image.data(), sizeof(header));
+            if (detail::completions_magic_ != header.magic || detail::completions_version_ != header.version) {
+                return false;
+            }
+
+            const auto payload = static_cast<std::size_t>(header.count) * sizeof(detail::completions_entry_) +
+                                 header.pool_size;
+            if (image.size() - sizeof(header) < payload) return false;
+
+            const auto entries = image.data() + sizeof(header);
+            for (std::uint32_t i = 0; i < header.count; ++i) {
+                detail::completions_entry_ entry{};
+                std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+                if (std::uint64_t{entry.name_offset} + entry.name_length > header.pool_size) return false;
+            }
+
+            entries_ = entries;
+            pool_ = entries + header.count * sizeof(detail::completions_entry_);
+            count_ = header.count;
+            size_ = sizeof(header) + payload;
+            return true;
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept { return nullptr != entries_; }
+        explicit operator bool() const noexcept { return is_valid(); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return count_; }
+        [[nodiscard]] bool empty() const noexcept { return 0 == count_; }
+
+        /**
+         * \brief The name at 'index' in sorted order (without dashes).
+         */
+        [[nodiscard]] std::string_view name(const std::size_t index) const noexcept {
+            const auto entry = entry_(index);
+            return {reinterpret_cast<const char *>(pool_) + entry.name_offset, entry.name_length};
+        }
+
+        /**
+         * \brief The index in the schema of the option at 'index' in sorted order.
+         */
+        [[nodiscard]] std::size_t option(const std::size_t index) const noexcept { return entry_(index).option; }
+
+        /**
+         * \brief The sorted positions [first, last) of the names that start with 'prefix'.
+         */
+        [[nodiscard]] std::pair<std::size_t, std::size_t> prefix_range(const std::string_view prefix) const noexcept {
+            std::size_t first = 0;
+            std::size_t last = count_;
+            while (first < last) {
+                const auto middle = first + (last - first) / 2;
+                if (name(middle) < prefix) first = middle + 1;
+                else last = middle;
+            }
+
+            last = count_;
+            auto lower = first;
+            while (lower < last) {
+                const auto middle = lower + (last - lower) / 2;
+                if (name(middle).starts_with(prefix)) lower = middle + 1;
+                else last = middle;
+            }
+            return {first, last};
+        }
+
+        /**
+         * \brief The schema index of the option named by 'prefix': the option with exactly that
+         *        name, or else the only option whose name starts with it; npos if there is none
+         *        or the abbreviation is ambiguous.
+         */
+        [[nodiscard]] std::size_t resolve(const std::string_view prefix) const noexcept {
+            const auto [first, last] = prefix_range(prefix);
+            if (first == last) return npos;
+            if (1 == last - first || name(first) == prefix) return option(first);
+            return npos;
+        }
+
+        /**
+         * \brief The serialized index.
+         */
+        [[nodiscard]] std::span<const std::byte> image() const noexcept {
+            return {entries_ ? entries_ - sizeof(detail::completions_header_) : nullptr, size_};
+        }
+
+        /**
+         * \brief Writes the serialized index to 'path'.
+         * @return false if the file could not be written.
+         */
+        bool save(const std::string &path) const {
+            const auto bytes = image();
+            auto *file = std::fopen(path.c_str(), "wb");
+            if (nullptr == file) return false;
+            const auto written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+            return 0 == std::fclose(file) && written == bytes.size();
+        }
+
+    private:
+        template<typename Name>
+        void build_(const std::size_t count, Name &&name_of) {
+            std::vector<std::uint32_t> order;
+            order.reserve(count);
+            std::size_t pool_size = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto name = name_of(i);
+                if (name.empty()) continue;
+                order.push_back(static_cast<std::uint32_t>(i));
+                pool_size += name.size();
+            }
+            if (pool_size > std::numeric_limits<std::uint32_t>::max()) return;
+            std::sort(order.begin(), order.end(),
+                      [&](const std::uint32_t a, const std::uint32_t b) { return name_of(a) < name_of(b); });
+
+            detail::completions_header_ header{};
+            header.magic = detail::completions_magic_;
+            header.version = detail::completions_version_;
+            header.count = static_cast<std::uint32_t>(order.size());
+            header.pool_size = static_cast<std::uint32_t>(pool_size);
+
+            // The header is assigned rather than copied into the resized image; GCC cannot prove
+            // that image is non-empty and reports a null dereference (-Wnull-dereference).
+            const auto *const header_bytes = reinterpret_cast<const std::byte *>(&header);
+            storage_.assign(header_bytes, header_bytes + sizeof(header));
+            storage_.resize(sizeof(header) + order.size() * sizeof(detail::completions_entry_) + pool_size);
+            auto *entries = storage_.data() + sizeof(header);
+            auto *pool = entries + order.size() * sizeof(detail::completions_entry_);
+
+            std::uint32_t offset = 0;
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                const auto name = name_of(order[i]);
+                std::memcpy(pool + offset, name.data(), name.size());
+                const detail::completions_entry_ entry{offset, static_cast<std::uint32_t>(name.size()), order[i]};
+                std::memcpy(entries + i * sizeof(entry), &entry, sizeof(entry));
+                offset += static_cast<std::uint32_t>(name.size());
+            }
+            open(storage_);
+        }
+
+        [[nodiscard]] detail::completions_entry_ entry_(const std::size_t index) const noexcept {
+            detail::completions_entry_ entry{};
+            std::memcpy(&entry, entries_ + index * sizeof(entry), sizeof(entry));
+            return entry;
+        }
+
+        std::vector<std::byte> storage_;
+        const std::byte *entries_{};
+        const std::byte *pool_{};
+        std::size_t count_{};
+        std::size_t size_{};
+    };
+
+    namespace detail {
+        /**
+         * \brief True if 'completions' holds exactly the long names of 'options', each under its
+         *        index. A linear walk of the names; nothing is sorted or allocated.
+         */
+        inline bool indexes_long_names_(const command_line_completions &completions, const option_names_ &options) noexcept {
+            std::size_t named = 0;
+            for (std::size_t i = 0; i < options.size(); ++i) {
+                if (!options.long_name(i).empty()) ++named;
+            }
+            if (named != completions.size()) return false;
+            for (std::size_t i = 0; i < completions.size(); ++i) {
+                const auto option = completions.option(i);
+                if (option >= options.size() || options.long_name(option) != completions.name(i)) return false;
+            }
+            return true;
+        }
+
+        /**
+         * \brief Resolves an abbreviated long name through a command_line_completions index of
+         *        the long names. The index is kept in the parser_context ('index'); the first
+         *        call of a parse checks it against the table and rebuilds it only if the table
+         *        is not the one it was built from.
+         */
+        inline std::size_t resolve_abbreviation_(abbreviation_index_ &index, const option_names_ &options,
+                                                 const std::string_view prefix, ambiguous_option_t &ambiguous) {
+            const auto *cached = static_cast<const command_line_completions *>(index.index.get());
+            if (!index.checked && (!cached || !indexes_long_names_(*cached, options))) {
+                index.index = std::make_shared<const command_line_completions>(options);
+            }
+            index.checked = true;
+            const auto &completions = *static_cast<const command_line_completions *>(index.index.get());
+            const auto [first, last] = completions.prefix_range(prefix);
+            if (1 == last - first) return completions.option(first);
+            ambiguous.candidate_count = last - first;
+            for (auto i = first; i < last && i - first < ambiguous_option_t::max_candidates; ++i) {
+                ambiguous.candidates.push_back("--" + std::string(completions.name(i)));
+            }
+            return npos_option;
+        }
+
+        inline const bool abbreviations_installed_ = [] {
+            parse_extensions_instance_().resolve_abbreviation.store(&resolve_abbreviation_, std::memory_order_release);
+            return true;
+        }();
+    }
+}
+
+#endif // CMD_LINE_COMPLETIONS_HH__
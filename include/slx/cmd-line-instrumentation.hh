@@ -0,0 +1,273 @@
+#pragma once
+#ifndef CMD_LINE_INSTRUMENTATION_HH__
+#define CMD_LINE_INSTRUMENTATION_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Define SLX_CMD_LINE_INSTRUMENTATION to count the work done by the parse and lookup
+// functions (see command_line_metrics). <slx/cmd-line-parsing.hh> includes this header only
+// then; without it the counting code is not compiled, the parser uses its own empty hooks,
+// and command_line_metrics returns no counts.
+//
+#if defined(SLX_CMD_LINE_INSTRUMENTATION)
+#   include <algorithm>
+#   include <array>
+#   include <atomic>
+#   include <chrono>
+#   include <cstring>
+#   include <mutex>
+#endif
+
+namespace slx {
+#if defined(SLX_CMD_LINE_INSTRUMENTATION)
+    inline constexpr bool command_line_instrumentation = true;
+#endif
+
+    /**
+     * \brief The counters of every thread, summed (see command_line_metrics).
+     */
+    struct command_line_metrics_t final {
+        struct key_t final {
+            std::string key;
+            std::uint64_t lookups{};
+            std::uint64_t nanoseconds{};
+        };
+
+        std::uint64_t parses{};
+        std::uint64_t parse_nanoseconds{};
+        std::uint64_t tokens_scanned{};
+        std::uint64_t name_comparisons{};
+        std::uint64_t allocations{};        // the results' nodes, bucket arrays and long strings
+        std::uint64_t lookups{};
+        std::uint64_t lookup_nanoseconds{};
+        std::vector<key_t> keys;            // per key lookups, most frequent first
+    };
+
+    namespace detail {
+#if defined(SLX_CMD_LINE_INSTRUMENTATION)
+        /**
+         * \brief The counters of one thread. Only the owning thread writes them (a relaxed load
+         *        and store, no read-modify-write), so counting takes no lock and no fence;
+         *        command_line_metrics reads them from other threads.
+         *
+         *        Lookups are counted per key in a small table whose slots are claimed by the
+         *        owning thread: it writes the name, then publishes the slot by storing the
+         *        hash of the name. Keys beyond the table are counted under "".
+         */
+        struct thread_metrics_ final {
+            struct key_slot_ final {
+                std::atomic<std::uint64_t> hash{};
+                std::array<char, 56> name{};
+                std::atomic<std::uint64_t> lookups{};
+                std::atomic<std::uint64_t> nanoseconds{};
+            };
+
+            static constexpr std::size_t key_capacity = 64;
+
+            std::atomic<std::uint64_t> parses{};
+            std::atomic<std::uint64_t> parse_nanoseconds{};
+            std::atomic<std::uint64_t> tokens_scanned{};
+            std::atomic<std::uint64_t> name_comparisons{};
+            std::atomic<std::uint64_t> allocations{};
+            std::atomic<std::uint64_t> lookups{};
+            std::atomic<std::uint64_t> lookup_nanoseconds{};
+            std::array<key_slot_, key_capacity> keys{};
+            key_slot_ other_keys{};
+        };
+
+        inline void add_(std::atomic<std::uint64_t> &counter, const std::uint64_t n) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        inline void add_metrics_(command_line_metrics_t &total, const thread_metrics_ &metrics) {
+            const auto load = [](const std::atomic<std::uint64_t> &c) { return c.load(std::memory_order_relaxed); };
+            total.parses += load(metrics.parses);
+            total.parse_nanoseconds += load(metrics.parse_nanoseconds);
+            total.tokens_scanned += load(metrics.tokens_scanned);
+            total.name_comparisons += load(metrics.name_comparisons);
+            total.allocations += load(metrics.allocations);
+            total.lookups += load(metrics.lookups);
+            total.lookup_nanoseconds += load(metrics.lookup_nanoseconds);
+
+            const auto add_key = [&](const std::string_view key, const thread_metrics_::key_slot_ &slot) {
+                const auto lookups = load(slot.lookups);
+                if (0 == lookups) return;
+                auto it = std::find_if(total.keys.begin(), total.keys.end(), [&](const auto &k) { return key == k.key; });
+                if (it == total.keys.end()) it = total.keys.insert(total.keys.end(), {std::string(key)});
+                it->lookups += lookups;
+                it->nanoseconds += load(slot.nanoseconds);
+            };
+            for (const auto &slot: metrics.keys) {
+                if (0 == slot.hash.load(std::memory_order_acquire)) break;
+                add_key(slot.name.data(), slot);
+            }
+            add_key({}, metrics.other_keys);
+        }
+
+        /**
+         * \brief The live threads' counters, and the sum of those of the threads that exited.
+         */
+        struct metrics_registry_ final {
+            std::mutex mutex;
+            std::vector<const thread_metrics_ *> threads;
+            command_line_metrics_t retired;
+        };
+
+        inline metrics_registry_ &metrics_registry_instance_() {
+            static metrics_registry_ registry;
+            return registry;
+        }
+
+        struct thread_metrics_owner_ final {
+            thread_metrics_owner_() {
+                auto &registry = metrics_registry_instance_();
+                const std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.threads.push_back(&metrics);
+            }
+
+            ~thread_metrics_owner_() {
+                auto &registry = metrics_registry_instance_();
+                const std::lock_guard<std::mutex> lock(registry.mutex);
+                add_metrics_(registry.retired, metrics);
+                std::erase(registry.threads, &metrics);
+            }
+
+            thread_metrics_ metrics;
+        };
+
+        inline thread_metrics_ &thread_metrics_instance_() {
+            thread_local thread_metrics_owner_ owner;
+            return owner.metrics;
+        }
+
+        inline std::uint64_t metrics_clock_() noexcept {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        inline thread_metrics_::key_slot_ &key_slot_of_(thread_metrics_ &metrics, const std::string_view key) noexcept {
+            auto hash = std::uint64_t{0xcbf29ce484222325ull};
+            for (const auto c: key) hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+            hash |= 1; // zero marks a free slot
+
+            if (key.size() >= thread_metrics_::key_slot_{}.name.size()) return metrics.other_keys;
+            for (auto &slot: metrics.keys) {
+                const auto slot_hash = slot.hash.load(std::memory_order_relaxed);
+                if (slot_hash == hash && key == slot.name.data()) return slot;
+                if (0 == slot_hash) {
+                    std::memcpy(slot.name.data(), key.data(), key.size());
+                    slot.hash.store(hash, std::memory_order_release);
+                    return slot;
+                }
+            }
+            return metrics.other_keys;
+        }
+
+        inline void count_tokens_scanned_(const std::size_t n) noexcept {
+            add_(thread_metrics_instance_().tokens_scanned, n);
+        }
+
+        inline void count_name_comparisons_(const std::size_t n) noexcept {
+            add_(thread_metrics_instance_().name_comparisons, n);
+        }
+
+        inline void count_allocations_(const std::size_t n) noexcept {
+            add_(thread_metrics_instance_().allocations, n);
+        }
+
+        /**
+         * \brief Counts the strings of a stored result that do not fit the inline buffer of a
+         *        std::string (the key, and the value).
+         */
+        inline void count_stored_strings_(const std::string_view key, const std::string_view value) noexcept {
+            static const auto inline_capacity = std::string().capacity();
+            add_(thread_metrics_instance_().allocations,
+                 (key.size() > inline_capacity ? 1 : 0) + (value.size() > inline_capacity ? 1 : 0));
+        }
+
+        /**
+         * \brief Counts a parse and its wall time, from construction to destruction.
+         */
+        class parse_timer_ final {
+        public:
+            parse_timer_() noexcept : start_(metrics_clock_()) {}
+
+            ~parse_timer_() {
+                auto &metrics = thread_metrics_instance_();
+                add_(metrics.parses, 1);
+                add_(metrics.parse_nanoseconds, metrics_clock_() - start_);
+            }
+
+        private:
+            std::uint64_t start_;
+        };
+
+        /**
+         * \brief Counts a lookup of 'key' and its time, from construction to destruction.
+         */
+        class lookup_timer_ final {
+        public:
+            explicit lookup_timer_(const std::string_view key) noexcept : key_(key), start_(metrics_clock_()) {}
+
+            ~lookup_timer_() {
+                const auto elapsed = metrics_clock_() - start_;
+                auto &metrics = thread_metrics_instance_();
+                add_(metrics.lookups, 1);
+                add_(metrics.lookup_nanoseconds, elapsed);
+                auto &slot = key_slot_of_(metrics, key_);
+                add_(slot.lookups, 1);
+                add_(slot.nanoseconds, elapsed);
+            }
+
+        private:
+            std::string_view key_;
+            std::uint64_t start_;
+        };
+#endif
+    }
+
+    /**
+     * \brief The counters of all threads, summed; the threads keep counting. Empty unless
+     *        SLX_CMD_LINE_INSTRUMENTATION is defined.
+     *
+     *        E.g.,
+     *        const auto metrics = slx::command_line_metrics();
+     *        log("parse: {} ns, {} tokens, {} comparisons", metrics.parse_nanoseconds,
+     *            metrics.tokens_scanned, metrics.name_comparisons);
+     */
+    [[nodiscard]] inline command_line_metrics_t command_line_metrics() {
+        command_line_metrics_t total;
+#if defined(SLX_CMD_LINE_INSTRUMENTATION)
+        auto &registry = detail::metrics_registry_instance_();
+        {
+            const std::lock_guard<std::mutex> lock(registry.mutex);
+            total = registry.retired;
+            for (const auto *metrics: registry.threads) detail::add_metrics_(total, *metrics);
+        }
+        std::sort(total.keys.begin(), total.keys.end(), [](const auto &a, const auto &b) { return a.lookups > b.lookups; });
+#endif
+        return total;
+    }
+}
+
+#endif // CMD_LINE_INSTRUMENTATION_HH__
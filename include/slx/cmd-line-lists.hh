@@ -0,0 +1,380 @@
+#pragma once
+#ifndef CMD_LINE_LISTS_HH__
+#define CMD_LINE_LISTS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-schema.hh"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <memory_resource>
+#include <span>
+
+namespace slx {
+    class command_line_lists;
+
+    namespace detail {
+        /**
+         * \brief The arity of an option; tables without arities (command_line_options_t) collect
+         *        every occurrence of an option.
+         */
+        template<typename OptionTable>
+        constexpr option_arity option_arity_of_(const OptionTable &options, const std::size_t index) noexcept {
+            if constexpr (requires { options.arity(index); }) return options.arity(index);
+            else return option_arity::repeated;
+        }
+
+        /**
+         * \brief An (option, value) pair recorded by the scan, before the values are grouped.
+         */
+        struct list_entry_ final {
+            std::size_t index;
+            std::string_view value;
+        };
+
+        /**
+         * \brief The most values that 'tokens' can store: one per token, except that a
+         *        short option token such as '-xvf' may be a bundle of one flag per letter.
+         */
+        template<typename Tokens>
+        std::size_t max_value_count_(const Tokens &tokens) noexcept {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < tokens.size(); ++i) {
+                const std::string_view token = tokens[i];
+                count += token_kind_::short_option == classify_token_(token).kind ? token.size() - 1 : 1;
+            }
+            return count;
+        }
+
+        template<typename T>
+        constexpr std::size_t arena_bytes_(const std::size_t n) noexcept {
+            return (n ? n : 1) * sizeof(T) + alignof(T) - 1;
+        }
+
+        struct command_line_lists_builder_;
+    }
+
+    /**
+     * \brief The result of try_parse_command_line_lists.
+     */
+    enum class parse_status : std::uint8_t { ok, missing_required, out_of_capacity };
+
+    /**
+     * \brief The values of every option of the last parse, with list semantics.
+     *
+     *        E.g.,
+     *        constexpr auto options = slx::make_command_line_schema({
+     *            {"include", "I", false, {}, {}, slx::option_arity::repeated},
+     *            {"inputs", "", true, {}, {}, slx::option_arity::multiple} });
+     *
+     *        slx::command_line_lists cmd_line;
+     *        slx::parse_command_line_lists(cmd_line, options, argc, argv, help_info);
+     *        for (std::string_view include : cmd_line.values("include")) { ... }
+     *
+     *        Every array of the result (the values of all options, grouped per option) comes from
+     *        one monotonic arena, so a parse costs a handful of allocations however many values
+     *        there are. The values view argv (or the response files, which the result owns), so
+     *        nothing is copied. Pass a buffer to the constructor to parse without touching the
+     *        heap until the buffer is exhausted. The arena is released by the next parse.
+     *
+     *        For code that may not allocate at all (e.g., after initialization or during early
+     *        startup), construct the lists over fixed storage sized with required_capacity and use
+     *        try_parse_command_line_lists.
+     */
+    class command_line_lists final {
+    public:
+        command_line_lists() = default;
+
+        command_line_lists(void *buffer, const std::size_t size,
+                           std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : arena_(buffer, size, upstream) {}
+
+        /**
+         * \brief Lists that only use 'storage'; a parse that needs more than its size fails with
+         *        parse_status::out_of_capacity (see try_parse_command_line_lists).
+         */
+        explicit command_line_lists(const std::span<std::byte> storage) noexcept
+            : arena_(storage.data(), storage.size(), std::pmr::null_memory_resource()), capacity_(storage.size()) {}
+
+        /**
+         * \brief The storage a fixed capacity parse of a command line of at most 'value_count'
+         *        values with a table of 'option_count' options is guaranteed to fit in. A command
+         *        line has at most one value per token (argc) unless it bundles short flags
+         *        ('-xvf' is three); max_value_count gives the bound of a given command line.
+         */
+        [[nodiscard]] static constexpr std::size_t required_capacity(const std::size_t option_count,
+                                                                     const std::size_t value_count) noexcept {
+            return detail::arena_bytes_<detail::list_entry_>(value_count) +
+                   detail::arena_bytes_<std::string_view>(value_count) +
+                   detail::arena_bytes_<std::string_view>(option_count) +
+                   2 * detail::arena_bytes_<std::size_t>(option_count + 1);
+        }
+
+        /**
+         * \brief The most values the command line can store: argc, plus one per additional
+         *        letter of each short option token that may be a bundle of flags.
+         */
+        [[nodiscard]] static std::size_t max_value_count(const int argc, char **argv) noexcept {
+            return detail::max_value_count_(detail::argv_tokens_(argc, argv));
+        }
+
+        /**
+         * \brief The size of the fixed storage, or zero if the lists may use the heap.
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+        command_line_lists(const command_line_lists &) = delete;
+        command_line_lists &operator=(const command_line_lists &) = delete;
+
+        /**
+         * \brief The number of options in the table of the last parse.
+         */
+        [[nodiscard]] std::size_t size() const noexcept { return option_count_; }
+
+        /**
+         * \brief The total number of values of all options.
+         */
+        [[nodiscard]] std::size_t value_count() const noexcept { return option_count_ ? offsets_[option_count_] : 0; }
+
+        [[nodiscard]] std::string_view app() const noexcept { return app_; }
+        [[nodiscard]] std::string_view long_name(const std::size_t index) const noexcept { return names_[index]; }
+
+        /**
+         * \brief Every value of the option at 'index' in the order given; a flag has one empty
+         *        value per occurrence.
+         */
+        [[nodiscard]] std::span<const std::string_view> values(const std::size_t index) const noexcept {
+            return {values_ + offsets_[index], offsets_[index + 1] - offsets_[index]};
+        }
+
+        [[nodiscard]] std::span<const std::string_view> values(const std::string_view key) const noexcept {
+            const auto index = find_(key);
+            return detail::npos_option != index ? values(index) : std::span<const std::string_view>{};
+        }
+
+        [[nodiscard]] bool contains(const std::size_t index) const noexcept { return offsets_[index] != offsets_[index + 1]; }
+        [[nodiscard]] bool contains(const std::string_view key) const noexcept { return !values(key).empty(); }
+
+        /**
+         * \brief The last value of the option or an empty view when it is not present.
+         */
+        [[nodiscard]] std::string_view operator[](const std::string_view key) const noexcept {
+            const auto list = values(key);
+            return list.empty() ? std::string_view{} : list.back();
+        }
+
+        /**
+         * \brief Discards the results and releases the arena.
+         */
+        void clear() noexcept {
+            names_ = nullptr;
+            offsets_ = nullptr;
+            values_ = nullptr;
+            option_count_ = 0;
+            app_ = {};
+            expansion_.reset();
+            arena_.release();
+        }
+
+    private:
+        friend struct detail::command_line_lists_builder_;
+
+        template<typename T>
+        T *allocate_(const std::size_t n) {
+            const auto p = static_cast<T *>(arena_.allocate((n ? n : 1) * sizeof(T), alignof(T)));
+            std::uninitialized_value_construct_n(p, n);
+            return p;
+        }
+
+        [[nodiscard]] std::size_t find_(const std::string_view key) const noexcept {
+            for (std::size_t i = 0; i < option_count_; ++i) {
+                if (key == names_[i]) return i;
+            }
+            return detail::npos_option;
+        }
+
+        std::pmr::monotonic_buffer_resource arena_;
+        std::shared_ptr<const void> expansion_;   // the response files viewed by the values
+        const std::string_view *names_{};
+        const std::size_t *offsets_{};
+        const std::string_view *values_{};
+        std::size_t option_count_{};
+        std::size_t capacity_{};
+        std::string_view app_{};
+    };
+
+    namespace detail {
+        struct command_line_lists_builder_ final {
+            /**
+             * \brief Scans 'tokens' into 'result' (already cleared). Allocates only from the
+             *        result's arena; at most required_capacity(options.size(),
+             *        max_value_count_(tokens)).
+             */
+            template<bool include_app_path, typename OptionTable, typename Tokens>
+            static void collect(command_line_lists &result, const OptionTable &options, const Tokens &tokens) {
+                if constexpr (include_app_path) {
+                    if (tokens.size() > 0) result.app_ = tokens[0];
+                }
+
+                // Record (option, value) pairs in the order given; a token stores one value, or
+                // one per flag of a bundle, so one array of max_value_count_ pairs suffices. A
+                // single valued option overwrites its pair.
+                //
+                const auto option_count = options.size();
+                const auto pending = result.template allocate_<list_entry_>(max_value_count_(tokens));
+                const auto last = result.template allocate_<std::size_t>(option_count + 1);
+                std::size_t pending_count = 0;
+
+                scan_command_line_tokens_(
+                    tokens, [&](const std::string_view token) { return options.match(token); },
+                    [&](const std::size_t index, const std::string_view value) {
+                        if (0 != last[index] && option_arity::single == option_arity_of_(options, index)) {
+                            pending[last[index] - 1].value = value;
+                            return;
+                        }
+                        pending[pending_count] = {index, value};
+                        last[index] = ++pending_count;
+                    },
+                    [&](const std::size_t index) { return option_arity::multiple == option_arity_of_(options, index); });
+
+                // Group the values by option (a stable counting sort).
+                //
+                const auto names = result.template allocate_<std::string_view>(option_count);
+                const auto offsets = result.template allocate_<std::size_t>(option_count + 1);
+                const auto values = result.template allocate_<std::string_view>(pending_count);
+                for (std::size_t i = 0; i < option_count; ++i) names[i] = options.long_name(i);
+                for (std::size_t p = 0; p < pending_count; ++p) ++offsets[pending[p].index + 1];
+                for (std::size_t i = 0; i < option_count; ++i) offsets[i + 1] += offsets[i];
+                for (std::size_t i = 0; i < option_count; ++i) last[i] = offsets[i];
+                for (std::size_t p = 0; p < pending_count; ++p) values[last[pending[p].index]++] = pending[p].value;
+
+                result.names_ = names;
+                result.offsets_ = offsets;
+                result.values_ = values;
+                result.option_count_ = option_count;
+            }
+
+            template<typename OptionTable>
+            static bool has_required(const command_line_lists &result, const OptionTable &options) noexcept {
+                for (std::size_t i = 0; i < options.size(); ++i) {
+                    if (options.is_required(i) && !result.contains(i)) return false;
+                }
+                return true;
+            }
+
+            template<bool include_app_path, typename OptionTable>
+            static const command_line_lists &parse(command_line_lists &result, const OptionTable &options,
+                                                   const int argc, char **argv,
+                                                   const std::function<void()> &publish_help_info,
+                                                   const parse_mode mode) {
+                result.clear();
+                if (const auto expand = response_files_only_expansion_(mode, "parse_command_line_lists")) {
+                    auto expanded = expand(argc, argv);
+                    result.expansion_ = std::move(expanded.owner);
+                    collect<include_app_path>(result, options, expanded.tokens);
+                } else {
+                    collect<include_app_path>(result, options, argv_tokens_(argc, argv));
+                }
+
+                if (!has_required(result, options) && publish_help_info) publish_help_info();
+                return result;
+            }
+
+            template<bool include_app_path, typename OptionTable>
+            static parse_status try_parse(command_line_lists &result, const OptionTable &options, const int argc,
+                                          char **argv) noexcept {
+                result.clear();
+                const argv_tokens_ tokens(argc, argv);
+
+                // Fixed storage is checked up front so that nothing is allocated (and nothing is
+                // thrown) when it is too small. Heap backed lists report a failed allocation.
+                //
+                if (0 != result.capacity_ &&
+                    command_line_lists::required_capacity(options.size(), max_value_count_(tokens)) > result.capacity_) {
+                    return parse_status::out_of_capacity;
+                }
+                try {
+                    collect<include_app_path>(result, options, tokens);
+                } catch (const std::bad_alloc &) {
+                    result.clear();
+                    return parse_status::out_of_capacity;
+                }
+                return has_required(result, options) ? parse_status::ok : parse_status::missing_required;
+            }
+        };
+    }
+
+    /**
+     * \brief Parses the command line into 'lists' (see command_line_lists). Every option of a
+     *        command_line_options_t table collects all of its occurrences.
+     * @return The results owned by 'lists'.
+     * @throw std::invalid_argument if 'mode' has parse_mode::strict or parse_mode::abbreviations
+     *        (see parse_mode).
+     */
+    template<bool include_app_path = true>
+    const command_line_lists &parse_command_line_lists(command_line_lists &lists, const command_line_options_t &options,
+                                                       const int argc, char **argv,
+                                                       const std::function<void()> &publish_help_info,
+                                                       const parse_mode mode = parse_mode::none) {
+        return detail::command_line_lists_builder_::parse<include_app_path>(
+            lists, detail::runtime_option_table_{options}, argc, argv, publish_help_info, mode);
+    }
+
+    /**
+     * \brief Parses the command line into 'lists' using the arity of each option of the schema.
+     */
+    template<bool include_app_path = true, std::size_t N>
+    const command_line_lists &parse_command_line_lists(command_line_lists &lists, const command_line_schema<N> &options,
+                                                       const int argc, char **argv,
+                                                       const std::function<void()> &publish_help_info,
+                                                       const parse_mode mode = parse_mode::none) {
+        return detail::command_line_lists_builder_::parse<include_app_path>(lists, options, argc, argv, publish_help_info, mode);
+    }
+    /**
+     * \brief Parses the command line into 'lists' without allocating from the global heap when
+     *        'lists' has fixed storage (see command_line_lists(std::span<std::byte>)) and
+     *        without throwing. Response files are not expanded and no help is published. A
+     *        command_line_options_t table is searched linearly (its hash index would be
+     *        allocated), so prefer a command_line_schema for large tables.
+     *
+     *        E.g.,
+     *        static std::array<std::byte, slx::command_line_lists::required_capacity(2, 64)> storage;
+     *        static slx::command_line_lists cmd_line(storage);
+     *        if (slx::parse_status::ok != slx::try_parse_command_line_lists(cmd_line, options, argc, argv)) { ... }
+     *
+     * @return parse_status::out_of_capacity if the storage is too small for the command line
+     *         (see command_line_lists::required_capacity),
+     *         parse_status::missing_required if a required option is absent.
+     */
+    template<bool include_app_path = true>
+    parse_status try_parse_command_line_lists(command_line_lists &lists, const command_line_options_t &options,
+                                              const int argc, char **argv) noexcept {
+        return detail::command_line_lists_builder_::try_parse<include_app_path>(
+            lists, detail::runtime_option_table_{options, /*may_index:*/ false}, argc, argv);
+    }
+
+    template<bool include_app_path = true, std::size_t N>
+    parse_status try_parse_command_line_lists(command_line_lists &lists, const command_line_schema<N> &options,
+                                              const int argc, char **argv) noexcept {
+        return detail::command_line_lists_builder_::try_parse<include_app_path>(lists, options, argc, argv);
+    }
+}
+
+#endif // CMD_LINE_LISTS_HH__
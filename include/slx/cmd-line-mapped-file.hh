@@ -0,0 +1,173 @@
+#pragma once
+#ifndef CMD_LINE_MAPPED_FILE_HH__
+#define CMD_LINE_MAPPED_FILE_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "compiler-support.hh"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(_WIN32)
+#   include <fstream>
+#   include <iterator>
+#   include <vector>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace slx {
+    /**
+     * \brief A file mapped into memory (read only, or copy on write so that the mapping may be
+     *        modified in place without touching the file).
+     *
+     *        E.g.,
+     *        slx::mapped_file records("audit.log");
+     *        if (!records) return EXIT_FAILURE;
+     *        std::string_view text = records.view();
+     *
+     *        On Windows the file is read into memory instead of being mapped.
+     */
+    class mapped_file final {
+    public:
+        enum class access { read_only, copy_on_write };
+
+        mapped_file() noexcept = default;
+
+        explicit mapped_file(const std::string &path, const access mode = access::read_only) { open(path, mode); }
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept { swap(other); }
+
+        mapped_file &operator=(mapped_file &&other) noexcept {
+            if (this != &other) {
+                close();
+                swap(other);
+            }
+            return *this;
+        }
+
+        ~mapped_file() { close(); }
+
+        /**
+         * \brief Maps the file; any previous mapping is released first.
+         * @return false if the file could not be opened or mapped.
+         */
+        bool open(const std::string &path, const access mode = access::read_only) {
+            close();
+#if defined(_WIN32)
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs) return false;
+            buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            is_open_ = true;
+            (void) mode;
+            return true;
+#else
+            const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            const auto mapped = map_(fd, mode);
+            ::close(fd);
+            return mapped;
+#endif
+        }
+
+#if !defined(_WIN32)
+        /**
+         * \brief Maps an open file descriptor (e.g., a memfd or a shared memory object); the
+         *        descriptor is not closed. Any previous mapping is released first.
+         * @return false if the descriptor could not be mapped.
+         */
+        bool open(const int fd, const access mode = access::read_only) {
+            close();
+            return map_(fd, mode);
+        }
+#endif
+
+        void close() noexcept {
+#if defined(_WIN32)
+            buffer_.clear();
+#else
+            if (data_) ::munmap(data_, size_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+            is_open_ = false;
+        }
+
+        [[nodiscard]] bool is_open() const noexcept { return is_open_; }
+        explicit operator bool() const noexcept { return is_open_; }
+
+        /**
+         * \brief The mapped bytes; writable only when mapped copy_on_write.
+         */
+        [[nodiscard]] char *data() noexcept { return data_; }
+        [[nodiscard]] const char *data() const noexcept { return data_; }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+
+    private:
+#if !defined(_WIN32)
+        bool map_(const int fd, const access mode) {
+            struct stat st{};
+            if (0 != ::fstat(fd, &st)) return false;
+
+            size_ = static_cast<std::size_t>(st.st_size);
+            if (size_ > 0) {
+                const auto protection = access::copy_on_write == mode ? PROT_READ | PROT_WRITE : PROT_READ;
+                const auto address = ::mmap(nullptr, size_, protection, MAP_PRIVATE, fd, 0);
+                if (MAP_FAILED == address) {
+                    size_ = 0;
+                    return false;
+                }
+                data_ = static_cast<char *>(address);
+                ::madvise(address, size_, MADV_SEQUENTIAL);
+            }
+            is_open_ = true;
+            return true;
+        }
+#endif
+
+        void swap(mapped_file &other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(is_open_, other.is_open_);
+#if defined(_WIN32)
+            std::swap(buffer_, other.buffer_);
+#endif
+        }
+
+        char *data_{};
+        std::size_t size_{};
+        bool is_open_{};
+#if defined(_WIN32)
+        std::vector<char> buffer_;
+#endif
+    };
+}
+
+#endif // CMD_LINE_MAPPED_FILE_HH__
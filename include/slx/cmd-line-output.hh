@@ -0,0 +1,131 @@
+#pragma once
+#ifndef CMD_LINE_OUTPUT_HH__
+#define CMD_LINE_OUTPUT_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// Define SLX_CMD_LINE_NO_IOSTREAM to write the output of the library with write(2) instead
+// of std::cout, so that a binary that does not otherwise use iostreams does not include
+// <iostream> (and does not pay for its static initialization at startup).
+//
+#if defined(SLX_CMD_LINE_NO_IOSTREAM)
+#   include <cerrno>
+#   if defined(_WIN32)
+#       include <io.h>
+#   else
+#       include <unistd.h>
+#   endif
+#else
+#   include <iostream>
+#endif
+
+namespace slx {
+    enum class output_stream : int { standard_output = 1, standard_error = 2 };
+
+    /**
+     * \brief Formats text into a stack buffer and writes it with one call when it is flushed
+     *        or destroyed (or when the buffer fills). The text is written with write(2) when
+     *        SLX_CMD_LINE_NO_IOSTREAM is defined and through std::cout/std::cerr otherwise.
+     *
+     *        E.g.,
+     *        auto help_info = []() {
+     *            slx::command_line_output out(slx::output_stream::standard_error);
+     *            out << "Error: Missing Required Options!\n"
+     *                << "  --in,  -i: [required] input file\n";
+     *        };
+     */
+    class command_line_output final {
+    public:
+        static constexpr std::size_t capacity = 4096;
+
+        explicit command_line_output(const output_stream stream = output_stream::standard_output) noexcept
+            : stream_(stream) {}
+
+        ~command_line_output() { flush(); }
+
+        command_line_output(const command_line_output &) = delete;
+        command_line_output &operator=(const command_line_output &) = delete;
+
+        command_line_output &operator<<(std::string_view text) {
+            while (text.size() > capacity - size_) {
+                const auto n = capacity - size_;
+                std::memcpy(buffer_.data() + size_, text.data(), n);
+                size_ += n;
+                text.remove_prefix(n);
+                flush();
+            }
+            std::memcpy(buffer_.data() + size_, text.data(), text.size());
+            size_ += text.size();
+            return *this;
+        }
+
+        command_line_output &operator<<(const char *text) { return *this << std::string_view(text ? text : ""); }
+
+        command_line_output &operator<<(const char c) { return *this << std::string_view(&c, 1); }
+
+        template<typename Integer>
+            requires std::is_integral_v<Integer>
+        command_line_output &operator<<(const Integer value) {
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            return *this << std::string_view(digits, static_cast<std::size_t>(result.ptr - digits));
+        }
+
+        /**
+         * \brief Writes the buffered text.
+         */
+        void flush() {
+            if (0 == size_) return;
+#if defined(SLX_CMD_LINE_NO_IOSTREAM)
+            const char *p = buffer_.data();
+            auto remaining = size_;
+            while (remaining > 0) {
+#   if defined(_WIN32)
+                const auto written = ::_write(static_cast<int>(stream_), p, static_cast<unsigned>(remaining));
+#   else
+                const auto written = ::write(static_cast<int>(stream_), p, remaining);
+#   endif
+                if (written < 0) {
+                    if (EINTR == errno) continue;
+                    break;
+                }
+                p += written;
+                remaining -= static_cast<std::size_t>(written);
+            }
+#else
+            auto &os = output_stream::standard_error == stream_ ? std::cerr : std::cout;
+            os.write(buffer_.data(), static_cast<std::streamsize>(size_));
+            os.flush();
+#endif
+            size_ = 0;
+        }
+
+    private:
+        std::array<char, capacity> buffer_;
+        std::size_t size_{};
+        output_stream stream_;
+    };
+}
+
+#endif // CMD_LINE_OUTPUT_HH__
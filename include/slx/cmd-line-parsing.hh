@@ -20,17 +20,138 @@
 // ----------------------------------------------------------------------------------------
 
 #include "compiler-support.hh"
+#include "cmd-line-output.hh"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <iostream>
 #include <tuple>
-#include <set>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// Define SLX_CMD_LINE_INSTRUMENTATION to count the work done by the parse and lookup
+// functions (see <slx/cmd-line-instrumentation.hh>). Without it the counting hooks are the
+// empty functions below and the instrumentation header is not included.
+//
+#if defined(SLX_CMD_LINE_INSTRUMENTATION)
+#   include "cmd-line-instrumentation.hh"
+#else
+namespace slx {
+    inline constexpr bool command_line_instrumentation = false;
+
+    namespace detail {
+        inline void count_tokens_scanned_(std::size_t) noexcept {}
+        inline void count_name_comparisons_(std::size_t) noexcept {}
+        inline void count_allocations_(std::size_t) noexcept {}
+        inline void count_stored_strings_(std::string_view, std::string_view) noexcept {}
+
+        class parse_timer_ final {};
+
+        class lookup_timer_ final {
+        public:
+            explicit constexpr lookup_timer_(std::string_view) noexcept {}
+        };
+    }
+}
+#endif
 
 namespace slx {
+    /**
+     * \brief A command line split from a single string (see <slx/cmd-line-tokenizer.hh>).
+     */
+    class command_line_tokens;
+
+    namespace detail {
+        /**
+         * \brief Lets the internal maps be searched with a std::string_view key without building
+         *        a std::string (heterogeneous lookup).
+         */
+        struct string_hash_ final {
+            using is_transparent = void;
+            std::size_t operator()(const std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+        };
+
+        /**
+         * \brief Finds 'key' in a map keyed by std::string; only maps with a transparent hash
+         *        (string_hash_) are searched without building a std::string.
+         */
+        template<typename Map>
+        auto find_key_(Map &map, const std::string_view key) {
+#if defined(__cpp_lib_generic_unordered_lookup)
+            if constexpr (requires { typename Map::hasher::is_transparent; }) return map.find(key);
+#endif
+            return map.find(std::string(key));
+        }
+
+        /**
+         * \brief The abbreviation index of the last option table parsed with
+         *        parse_mode::abbreviations in a parser_context (see resolve_abbreviation in
+         *        parse_extensions_). 'checked' is cleared by every parse, so the index is checked
+         *        against the table once per parse and rebuilt only when the table differs.
+         */
+        struct abbreviation_index_ final {
+            std::shared_ptr<const void> index;
+            bool checked{};
+        };
+
+        struct parser_context_access_;
+    }
+
+    /**
+     * \brief Optional parsing behaviour; combine with '|'.
+     *
+     *        response_files: a token '@path' is replaced by the tokens of the file 'path'
+     *                        (see command_line_expansion).
+     *        strict:         a token that looks like an option ('-x', '--xyz') but is not
+     *                        registered is reported, with the closest registered name, instead
+     *                        of being ignored (see parser_context::unknown_options).
+     *        abbreviations:  '--name' also matches the only long name that starts with 'name'
+     *                        (e.g., '--enable-vec' for '--enable-vectorized-io'); a prefix of
+     *                        several names is reported (see parser_context::ambiguous_options).
+     *
+     *        The implementations live in headers that this one does not include, so that a
+     *        program pays for them only if it uses them: response files need
+     *        <slx/cmd-line-response-files.hh>, abbreviations <slx/cmd-line-completions.hh> and
+     *        the suggestions of a strict parse <slx/cmd-line-suggestions.hh>. Including the
+     *        header in any translation unit of the program enables the mode. A parse that asks
+     *        for a mode whose header is not part of the program throws std::logic_error rather
+     *        than ignoring the mode. The headers register the modes during static
+     *        initialization, so a parse that runs during static initialization (e.g., the
+     *        initializer of a global) must be in a translation unit that includes them first.
+     *
+     *        strict and abbreviations report into a parser_context, so only the parses that
+     *        have one (parse_command_line_args) support them; parse_command_line_views and
+     *        parse_command_line_lists accept response_files only and throw
+     *        std::invalid_argument for the others.
+     */
+    enum class parse_mode : unsigned {
+        none = 0,
+        response_files = 1u << 0,
+        strict = 1u << 1,
+        abbreviations = 1u << 2
+    };
+
+    constexpr parse_mode operator|(const parse_mode a, const parse_mode b) noexcept {
+        return static_cast<parse_mode>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+    }
+
+    namespace detail {
+        constexpr bool has_parse_mode_(const parse_mode mode, const parse_mode flag) noexcept {
+            return 0 != (static_cast<unsigned>(mode) & static_cast<unsigned>(flag));
+        }
+    }
+
     /**
      * \brief Stores the parsed results of the commandline. Where the first string is the long form
      *        of the option name and the second string is its value.
@@ -49,50 +170,339 @@ namespace slx {
      */
     using command_line_options_t = ::std::vector <std::tuple<std::string, std::string, bool>>;
 
+    /**
+     * \brief An unregistered option found by a parse_mode::strict parse: the token as given and
+     *        the closest registered name (e.g., '--thread' and '--threads'), which is empty
+     *        if no registered name is close.
+     */
+    struct unknown_option_t final {
+        std::string token;
+        std::string suggestion;
+    };
+
+    /**
+     * \brief An abbreviation found by a parse_mode::abbreviations parse that is the prefix of
+     *        several long names: the token as given and the names it could stand for (e.g.,
+     *        '--enable-v' and '--enable-vectorized-io', '--enable-verbose-log').
+     *
+     *        At most max_candidates names are listed, in sorted order, so that a command line of
+     *        short prefixes against a large table costs linear time and memory; 'candidate_count'
+     *        is the number of names that have the prefix.
+     */
+    struct ambiguous_option_t final {
+        static constexpr std::size_t max_candidates = 8;
+
+        std::string token;
+        std::vector<std::string> candidates;
+        std::size_t candidate_count{};
+    };
+
+    /**
+     * \brief Owns the results of a parse.
+     *
+     *        Each parser_context is independent; a worker that parses many argument vectors
+     *        should own one context and reuse it. Nothing is shared between contexts, so
+     *        contexts may be used concurrently from different threads without locking.
+     *
+     *        E.g.,
+     *        slx::parser_context context;
+     *        slx::parse_command_line_args(context, options, argc, argv, [](){});
+     *        auto input_file = context.option("in");
+     *
+     *        The global functions (parse_command_line_args without a context,
+     *        get_command_line_option, etc.) operate on global_parser_context().
+     */
+    class parser_context final {
+    public:
+        [[nodiscard]] const command_line_options_result_t &args() const noexcept { return args_; }
+        [[nodiscard]] command_line_options_result_t &args() noexcept { return args_; }
+
+        /**
+         * \brief Check if the last parse contained the option.
+         */
+        [[nodiscard]] bool has_option(const std::string_view key) const {
+            return detail::find_key_(args_, key) != args_.end();
+        }
+
+        /**
+         * \brief The value of the option or an empty string if it was not present.
+         */
+        [[nodiscard]] std::string option(const std::string_view key) const {
+            const auto it = detail::find_key_(args_, key);
+            return it != args_.end() ? it->second : std::string{};
+        }
+
+        /**
+         * \brief The long names of every required option that was missing from the last parse.
+         */
+        [[nodiscard]] const std::vector<std::string> &missing_options() const noexcept { return missing_; }
+        [[nodiscard]] std::vector<std::string> &missing_options() noexcept { return missing_; }
+
+        /**
+         * \brief The unregistered options of the last parse_mode::strict parse.
+         */
+        [[nodiscard]] const std::vector<unknown_option_t> &unknown_options() const noexcept { return unknown_; }
+        [[nodiscard]] std::vector<unknown_option_t> &unknown_options() noexcept { return unknown_; }
+
+        /**
+         * \brief The ambiguous abbreviations of the last parse_mode::abbreviations parse.
+         */
+        [[nodiscard]] const std::vector<ambiguous_option_t> &ambiguous_options() const noexcept { return ambiguous_; }
+        [[nodiscard]] std::vector<ambiguous_option_t> &ambiguous_options() noexcept { return ambiguous_; }
+
+        void clear() noexcept {
+            args_.clear();
+            missing_.clear();
+            unknown_.clear();
+            ambiguous_.clear();
+        }
+
+    private:
+        friend struct detail::parser_context_access_;
+
+        command_line_options_result_t args_;
+        std::vector<std::string> missing_;
+        std::vector<unknown_option_t> unknown_;
+        std::vector<ambiguous_option_t> ambiguous_;
+        detail::abbreviation_index_ abbreviations_;
+    };
+
+    /**
+     * \brief The context used by the global (context free) functions.
+     */
+    inline parser_context &global_parser_context() {
+        static parser_context context;
+        return context;
+    }
+
+    namespace detail {
+        struct parser_context_access_ final {
+            static abbreviation_index_ &abbreviations(parser_context &context) noexcept { return context.abbreviations_; }
+        };
+
+        /**
+         * \brief Parses registered to run on the first access to the global results (see
+         *        defer_command_line_parse). 'pending' is set while any has not run, so once
+         *        they have, an access costs a single atomic load.
+         */
+        struct deferred_parses_ final {
+            std::mutex mutex;
+            std::vector<std::function<void()>> parses;
+            std::size_t completed{};
+            std::atomic<bool> pending{false};
+        };
+
+        inline deferred_parses_ &deferred_parses_instance_() {
+            static deferred_parses_ deferred;
+            return deferred;
+        }
+
+        inline void defer_global_parse_(std::function<void()> parse) {
+            auto &deferred = deferred_parses_instance_();
+            const std::lock_guard<std::mutex> lock(deferred.mutex);
+            deferred.parses.push_back(std::move(parse));
+            deferred.pending.store(true, std::memory_order_release);
+        }
+
+        /**
+         * \brief Runs the deferred parses that have not run yet, once, on the first thread to
+         *        get here; other threads wait for them. An access from within a deferred parse
+         *        (e.g., by its help function) sees the results as they are.
+         *
+         *        A parse that throws is not run again; the exception propagates and the
+         *        parses registered after it run on the next access.
+         */
+        inline void run_deferred_parses_() {
+            auto &deferred = deferred_parses_instance_();
+            if (!deferred.pending.load(std::memory_order_acquire)) return;
+
+            thread_local bool running = false;
+            if (running) return;
+            const std::lock_guard<std::mutex> lock(deferred.mutex);
+            struct running_scope_ final {
+                bool &running;
+                explicit running_scope_(bool &flag) noexcept : running(flag) { running = true; }
+                ~running_scope_() { running = false; }
+            } scope(running);
+            while (deferred.completed < deferred.parses.size()) deferred.parses[deferred.completed++]();
+            deferred.pending.store(false, std::memory_order_release);
+        }
+
+        /**
+         * \brief run_deferred_parses_ for the noexcept accessors: a parse that throws leaves
+         *        the results as they were when it threw.
+         */
+        inline void try_run_deferred_parses_() noexcept {
+            try {
+                run_deferred_parses_();
+            }
+            catch (...) {
+            }
+        }
+    }
+
     /**
      * \brief Internal use only; do not call directly.
      * @return A static non-const pointer to a map of key/value pairs.
      */
     inline command_line_options_result_t *get_command_line_args_() {
-        static command_line_options_result_t command_line;
-        return &command_line;
+        detail::run_deferred_parses_();
+        return &global_parser_context().args();
+    }
+
+    /**
+     * \brief An immutable, reference counted set of parse results (see command_line_snapshot).
+     */
+    using command_line_snapshot_t = std::shared_ptr<const command_line_options_result_t>;
+
+    namespace detail {
+        /**
+         * \brief The published snapshot; swapped and read with atomic operations only.
+         */
+        inline std::atomic<command_line_snapshot_t> &snapshot_slot_instance_() {
+            static std::atomic<command_line_snapshot_t> slot{std::make_shared<const command_line_options_result_t>()};
+            return slot;
+        }
+    }
+
+    /**
+     * \brief Atomically replaces the published snapshot with 'args'. Readers that hold the
+     *        previous snapshot keep it until they release their handle.
+     *
+     *        The global parse_command_line_args publishes its results this way.
+     */
+    inline void publish_command_line_snapshot(command_line_snapshot_t snapshot) {
+        // The previous snapshot is released here if this was its last reference.
+        //
+        detail::snapshot_slot_instance_().exchange(std::move(snapshot), std::memory_order_acq_rel);
+    }
+
+    inline void publish_command_line_snapshot(command_line_options_result_t args) {
+        publish_command_line_snapshot(std::make_shared<const command_line_options_result_t>(std::move(args)));
+    }
+
+    /**
+     * \brief The published snapshot of the parse results; a read only handle that keeps the
+     *        results alive for as long as it is held, across later publications.
+     *
+     *        E.g.,
+     *        const auto args = slx::command_line_snapshot();
+     *        auto it = args->find("threads");
+     *
+     *        A call loads a std::atomic<std::shared_ptr>, without a mutex or a per thread
+     *        cache, and the results are never copied.
+     */
+    inline command_line_snapshot_t command_line_snapshot() {
+        detail::run_deferred_parses_();
+        return detail::snapshot_slot_instance_().load(std::memory_order_acquire);
     }
 
    /**
     * TODO: Evaluate...Is the even required. 
+    *
+    * Also publishes an empty snapshot, so the global accessors see no options afterwards.
     */
     inline void clear_command_line_options() {
-        get_command_line_args_()->clear();
+        global_parser_context().clear();
+        publish_command_line_snapshot(command_line_options_result_t{});
     }
 
     /**
      * \brief Provide global access to the commandline arguments within an application.
-     * @return A copy of the command_line_options_result_t, a std::unordered_map.
+     *        Prefer command_line_snapshot(), which does not copy the results.
+     * @return A copy of the published snapshot, a std::unordered_map.
      */
     inline command_line_options_result_t get_command_line_args() {
-        return *get_command_line_args_();
+        return *command_line_snapshot();
     }
 
     /**
-     * \brief Check if the command line contained the option.
+     * \brief Check if the command line contained the option. Reads the published snapshot,
+     *        so a concurrent parse or clear_command_line_options is not a data race.
      * @param key
      * @return true if option is present on the command line.
      */
     inline bool command_line_option(const std::string_view key)
     {
-        return get_command_line_args_()->count(key.data()) > 0;
+        const auto args = command_line_snapshot();
+        [[maybe_unused]] const detail::lookup_timer_ timer(key);
+        return detail::find_key_(*args, key) != args->end();
     }
 
     /**
-    * \brief Get the command line contained the option.
+    * \brief Get the command line contained the option (see command_line_option). The first
+    *        access runs any deferred parse (see defer_command_line_parse); if that, or the copy
+    *        of the value, throws, an empty string is returned.
     * @param key
-    * @return true if option is present on the command line.
+    * @return The value of the option, or an empty string if it was not present.
     */
     inline std::string get_command_line_option(const std::string_view key) noexcept
     {
-        auto c = get_command_line_args_();
-        if (c->count(key.data())) { return (*c)[key.data()]; }
-        return {};
+        try {
+            const auto args = command_line_snapshot();
+            [[maybe_unused]] const detail::lookup_timer_ timer(key);
+            const auto it = detail::find_key_(*args, key);
+            return it != args->end() ? it->second : std::string{};
+        }
+        catch (...) {
+            return {};
+        }
+    }
+
+    /**
+     * \brief Check if 'snapshot' contains the option.
+     */
+    inline bool command_line_option(const command_line_snapshot_t &snapshot, const std::string_view key)
+    {
+        [[maybe_unused]] const detail::lookup_timer_ timer(key);
+        return snapshot && detail::find_key_(*snapshot, key) != snapshot->end();
+    }
+
+    /**
+     * \brief The value of the option in 'snapshot', without copying it; the view is valid for
+     *        as long as the snapshot is held.
+     *
+     *        E.g.,
+     *        const auto config = slx::command_line_snapshot();
+     *        const std::string_view threads = slx::get_command_line_option(config, "threads");
+     *
+     * @return The value of the option, or an empty view if it was not present.
+     */
+    inline std::string_view get_command_line_option(const command_line_snapshot_t &snapshot,
+                                                    const std::string_view key)
+    {
+        if (!snapshot) return {};
+        [[maybe_unused]] const detail::lookup_timer_ timer(key);
+        const auto it = detail::find_key_(*snapshot, key);
+        return it != snapshot->end() ? std::string_view(it->second) : std::string_view{};
+    }
+
+    /**
+    * \brief The long names of every required option that was missing from the last parse.
+    *        A deferred parse that throws is not propagated (see defer_command_line_parse).
+    */
+    inline const std::vector<std::string> &get_missing_command_line_options() noexcept
+    {
+        detail::try_run_deferred_parses_();
+        return global_parser_context().missing_options();
+    }
+
+    /**
+    * \brief The unregistered options of the last parse_mode::strict parse.
+    */
+    inline const std::vector<unknown_option_t> &get_unknown_command_line_options() noexcept
+    {
+        detail::try_run_deferred_parses_();
+        return global_parser_context().unknown_options();
+    }
+
+    /**
+    * \brief The ambiguous abbreviations of the last parse_mode::abbreviations parse.
+    */
+    inline const std::vector<ambiguous_option_t> &get_ambiguous_command_line_options() noexcept
+    {
+        detail::try_run_deferred_parses_();
+        return global_parser_context().ambiguous_options();
     }
 
     /**
@@ -103,16 +513,18 @@ namespace slx {
         if constexpr(debug_only)
         {
 #ifndef NDEBUG
-            std::cout << " Command Line Args:";
-            for (auto i = 0; i < argc; ++i) std::cout << "\n  [" << i << "]: " << argv[i];
-            std::cout << "\n" << std::endl;
+            command_line_output out;
+            out << " Command Line Args:";
+            for (auto i = 0; i < argc; ++i) out << "\n  [" << i << "]: " << argv[i];
+            out << "\n\n";
 #endif
         }
         else
         {
-            std::cout << " Command Line Args:";
-            for (auto i = 0; i < argc; ++i) std::cout << "\n  [" << i << "]: " << argv[i];
-            std::cout << "\n" << std::endl;
+            command_line_output out;
+            out << " Command Line Args:";
+            for (auto i = 0; i < argc; ++i) out << "\n  [" << i << "]: " << argv[i];
+            out << "\n\n";
         }
     }
 
@@ -124,16 +536,605 @@ namespace slx {
         if constexpr(debug_only)
         {
 #ifndef NDEBUG
-            std::cout << " Command Line Parse Results:\n";
-            for (const auto &[key, value]: slx::get_command_line_args())
-                std::cout << "  [\"" << key << "\"]: " << value << "\n";
+            command_line_output out;
+            out << " Command Line Parse Results:\n";
+            const auto args = command_line_snapshot();
+            for (const auto &[key, value]: *args)
+                out << "  [\"" << key << "\"]: " << value << "\n";
 #endif
         }
         else
         {
-            std::cout << " Command Line Parse Results:\n";
-            for (const auto &[key, value]: slx::get_command_line_args())
-                std::cout << "  [\"" << key << "\"]: " << value << "\n";
+            command_line_output out;
+            out << " Command Line Parse Results:\n";
+            const auto args = command_line_snapshot();
+            for (const auto &[key, value]: *args)
+                out << "  [\"" << key << "\"]: " << value << "\n";
+        }
+    }
+
+    namespace detail {
+        /**
+         * \brief Returned by the option tables when a token does not name a registered option.
+         */
+        inline constexpr auto npos_option = static_cast<std::size_t>(-1);
+
+        /**
+         * \brief On some platforms (e.g., Windows, extra quotes are added to arguments by the
+         *        operating system). These are removed by narrowing the view; nothing is copied.
+         */
+        constexpr std::string_view strip_quotes_(std::string_view value) noexcept {
+            if (value.size() >= 2 && '\"' == value.front() && '\"' == value.back()) {
+                value.remove_prefix(1);
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+
+        /**
+         * \brief A dense bitset indexed by option; the words of the first 256 options are kept
+         *        inline, so most tables never allocate.
+         */
+        class option_bitset_ final {
+        public:
+            explicit option_bitset_(const std::size_t size) : word_count_((size + 63) / 64) {
+                if (word_count_ > inline_words_) heap_.assign(word_count_, 0);
+            }
+
+            void set(const std::size_t index) noexcept { data()[index / 64] |= std::uint64_t{1} << (index % 64); }
+
+            void reset() noexcept { std::fill_n(data(), word_count_, std::uint64_t{0}); }
+
+            [[nodiscard]] bool test(const std::size_t index) const noexcept {
+                return 0 != (words()[index / 64] & (std::uint64_t{1} << (index % 64)));
+            }
+
+            [[nodiscard]] std::span<const std::uint64_t> words() const noexcept {
+                return {heap_.empty() ? inline_.data() : heap_.data(), word_count_};
+            }
+
+        private:
+            static constexpr std::size_t inline_words_ = 4;
+
+            [[nodiscard]] std::uint64_t *data() noexcept { return heap_.empty() ? inline_.data() : heap_.data(); }
+
+            std::size_t word_count_;
+            std::array<std::uint64_t, inline_words_> inline_{};
+            std::vector<std::uint64_t> heap_;
+        };
+
+        /**
+         * \brief Calls 'visit(index)' for every required option of 'options' that is not set in
+         *        'present'. The required_mask of the table (a schema, or a runtime table) is
+         *        checked against 'present' a word (64 options) at a time.
+         */
+        template<typename OptionTable, typename Visit>
+        void for_each_missing_(const option_bitset_ &present, const OptionTable &options, Visit &&visit) {
+            const auto required = options.required_mask();
+            const auto words = present.words();
+            for (std::size_t w = 0; w < required.size(); ++w) {
+                for (auto missing = required[w] & ~words[w]; 0 != missing; missing &= missing - 1) {
+                    visit(w * 64 + static_cast<std::size_t>(std::countr_zero(missing)));
+                }
+            }
+        }
+
+        /**
+         * \brief FNV-1a over the option name. The seed differs for long and short names so
+         *        that '--x' and '-x' never share a key.
+         */
+        constexpr std::uint64_t hash_option_name_(const std::string_view name, const bool is_long) noexcept {
+            std::uint64_t h = is_long ? 0xcbf29ce484222325ull : 0x84222325cbf29ce4ull;
+            for (const auto c: name) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        /**
+         * \brief Adapts the runtime command_line_options_t vector to the option table interface
+         *        used by the parser (size, long_name, is_required, required_mask and match).
+         *
+         *        Matching compares views of the token against the registered names so that no
+         *        temporary strings are built per comparison. Small tables are searched linearly.
+         *        Once the names compared exceed the size of the table (a large table, or many
+         *        tokens), a hash index of the names is built so that the rest of the parse
+         *        costs one probe per token. A parse that may not allocate passes
+         *        'may_index = false' and is always searched linearly.
+         *
+         *        Like the index, the mask of the required options is built once, on first use,
+         *        so that the missing options are found a word at a time, as for a schema.
+         */
+        class runtime_option_table_ final {
+        public:
+            explicit runtime_option_table_(const command_line_options_t &options, const bool may_index = true) noexcept
+                : options_(options), may_index_(may_index) {}
+
+            [[nodiscard]] std::size_t size() const noexcept { return options_.size(); }
+
+            [[nodiscard]] std::string_view long_name(const std::size_t index) const noexcept {
+                return std::get<0>(options_[index]);
+            }
+
+            [[nodiscard]] std::string_view short_name(const std::size_t index) const noexcept {
+                return std::get<1>(options_[index]);
+            }
+
+            [[nodiscard]] bool is_required(const std::size_t index) const noexcept {
+                return std::get<2>(options_[index]);
+            }
+
+            [[nodiscard]] std::span<const std::uint64_t> required_mask() const {
+                if (!required_) {
+                    required_.emplace(options_.size());
+                    for (std::size_t i = 0; i < options_.size(); ++i) {
+                        if (std::get<2>(options_[i])) required_->set(i);
+                    }
+                }
+                return required_->words();
+            }
+
+            /**
+             * \brief Maps '--long' or '-short' to the index of the option, otherwise npos_option.
+             */
+            [[nodiscard]] std::size_t match(const std::string_view token) const {
+                if (token.size() < 2 || '-' != token[0]) return npos_option;
+                const auto is_long = '-' == token[1];
+                const auto name = token.substr(is_long ? 2 : 1);
+                if (name.empty()) return npos_option;
+
+                if (!slots_.empty()) return find_(name, is_long);
+                if (may_index_ && compared_ > options_.size() && options_.size() > linear_size_) {
+                    build_index_();
+                    return find_(name, is_long);
+                }
+                compared_ += options_.size();
+                const auto it = std::find_if(options_.begin(), options_.end(), [&](const auto &p) {
+                    return name == (is_long ? std::get<0>(p) : std::get<1>(p));
+                });
+                const auto index = static_cast<std::size_t>(it - options_.begin());
+                count_name_comparisons_(it != options_.end() ? index + 1 : index);
+                return it != options_.end() ? index : npos_option;
+            }
+
+        private:
+            static constexpr std::size_t linear_size_ = 8;
+
+            // A slot holds ((option index << 1) | is_short) + 1; zero marks an empty slot. The
+            // first option registered under a name wins, as with the linear search.
+            //
+            void build_index_() const {
+                std::size_t capacity = 16;
+                while (capacity < options_.size() * 4) capacity <<= 1;
+                slots_.assign(capacity, 0);
+                for (std::size_t i = 0; i < options_.size(); ++i) {
+                    for (const auto is_long: {true, false}) {
+                        const std::string_view name = is_long ? std::get<0>(options_[i]) : std::get<1>(options_[i]);
+                        if (name.empty()) continue;
+                        auto slot = hash_option_name_(name, is_long) & (capacity - 1);
+                        for (; 0 != slots_[slot]; slot = (slot + 1) & (capacity - 1)) {
+                            if (is_slot_of_(slots_[slot], name, is_long)) break;
+                        }
+                        if (0 == slots_[slot]) slots_[slot] = static_cast<std::uint32_t>((i << 1 | (is_long ? 0u : 1u)) + 1);
+                    }
+                }
+            }
+
+            [[nodiscard]] std::size_t find_(const std::string_view name, const bool is_long) const noexcept {
+                const auto mask = slots_.size() - 1;
+                std::size_t probes = 0;
+                for (auto slot = hash_option_name_(name, is_long) & mask; 0 != slots_[slot]; slot = (slot + 1) & mask) {
+                    ++probes;
+                    if (is_slot_of_(slots_[slot], name, is_long)) {
+                        count_name_comparisons_(probes);
+                        return (slots_[slot] - 1) >> 1;
+                    }
+                }
+                count_name_comparisons_(probes);
+                return npos_option;
+            }
+
+            [[nodiscard]] bool is_slot_of_(const std::uint32_t code, const std::string_view name,
+                                           const bool is_long) const noexcept {
+                const auto is_short = 0 != ((code - 1) & 1u);
+                if (is_short == is_long) return false;
+                const auto &option = options_[(code - 1) >> 1];
+                return name == (is_long ? std::get<0>(option) : std::get<1>(option));
+            }
+
+            const command_line_options_t &options_;
+            bool may_index_;
+            mutable std::vector<std::uint32_t> slots_;
+            mutable std::optional<option_bitset_> required_;
+            mutable std::size_t compared_{};
+        };
+
+        /**
+         * \brief Presents argc/argv as a sequence of string views (a null entry is an empty view).
+         */
+        class argv_tokens_ final {
+        public:
+            argv_tokens_(const int argc, char **argv) noexcept
+                : argv_(argv), argc_(argc > 0 ? static_cast<std::size_t>(argc) : 0) {}
+
+            [[nodiscard]] std::size_t size() const noexcept { return argc_; }
+
+            [[nodiscard]] std::string_view operator[](const std::size_t i) const noexcept {
+                return argv_[i] ? std::string_view(argv_[i]) : std::string_view{};
+            }
+
+        private:
+            char **argv_;
+            std::size_t argc_;
+        };
+
+        enum class token_kind_ : std::uint8_t { value, long_option, short_option, end_of_options };
+
+        /**
+         * \brief The shape of a token, decided by its first bytes:
+         *
+         *        value:          '', '-', or anything that does not start with '-';
+         *        end_of_options: '--';
+         *        long_option:    '--name' or '--name=value';
+         *        short_option:   '-n', '-nvalue' or '-xvf'; 'numeric' if it could also be a
+         *                        negative number ('-5', '-.5').
+         */
+        struct token_shape_ final {
+            token_kind_ kind{token_kind_::value};
+            bool numeric{};
+        };
+
+        constexpr token_shape_ classify_token_(const std::string_view token) noexcept {
+            const auto size = token.size();
+            if (size < 2 || '-' != token[0]) return {};
+            if ('-' == token[1]) return {2 == size ? token_kind_::end_of_options : token_kind_::long_option};
+            const auto digit = [&](const std::size_t i) { return i < size && token[i] >= '0' && token[i] <= '9'; };
+            return {token_kind_::short_option, digit(1) || ('.' == token[1] && digit(2))};
+        }
+
+        /**
+         * \brief An option named by a token at an option position (see split_option_token_):
+         *        'takes_value' is true if the next token may be its value, i.e., the token did not
+         *        carry one.
+         */
+        struct option_token_ final {
+            std::size_t index{npos_option};
+            bool takes_value{};
+        };
+
+        /**
+         * \brief Decides what an option or '-'-prefixed token at an option position names (see
+         *        classify_token_ for 'shape'); shared by scan_command_line_tokens_ and
+         *        command_line_stream so that both split tokens the same way.
+         *
+         *        A registered name is matched whole first, so names may contain '=' or digits.
+         *        Otherwise '--name=value' and '-nvalue' carry their value and '-xvf' is the flags
+         *        '-x' and '-v', passed to 'store' with an empty value, followed by '-f', which is
+         *        returned, when each one is a registered short name. A negative number ('-5')
+         *        names nothing, and any other token that matches nothing is passed to 'unknown'.
+         */
+        template<typename Match, typename Store, typename Unknown>
+        option_token_ split_option_token_(const std::string_view token, const token_shape_ shape, Match &&match,
+                                          Store &&store, Unknown &&unknown) {
+            if (const auto index = match(token); npos_option != index) return {index, true};
+
+            const auto match_short = [&](const char c) {
+                const char flag[2] = {'-', c};
+                return match(std::string_view(flag, 2));
+            };
+
+            if (token_kind_::long_option == shape.kind) {
+                const auto separator = token.find('=', 2);
+                const auto index = std::string_view::npos != separator ? match(token.substr(0, separator))
+                                                                       : npos_option;
+                if (npos_option == index) {
+                    unknown(token);
+                    return {};
+                }
+                store(index, strip_quotes_(token.substr(separator + 1)));
+                return {index, false};
+            }
+
+            if (shape.numeric) return {};
+            const auto first = 2 < token.size() ? match_short(token[1]) : npos_option;
+            if (npos_option == first) {
+                unknown(token);
+                return {};
+            }
+
+            const auto bundled = std::all_of(token.begin() + 2, token.end(),
+                                             [&](const char c) { return npos_option != match_short(c); });
+            if (!bundled) {
+                store(first, strip_quotes_(token.substr(2)));
+                return {first, false};
+            }
+            for (std::size_t j = 1; j + 1 < token.size(); ++j) store(match_short(token[j]), std::string_view{});
+            return {match_short(token.back()), true};
+        }
+
+        /**
+         * \brief Walks a token sequence once (skipping the application path at index 0),
+         *        handing each registered option and its value to 'store'.
+         *
+         *        'tokens' is any sequence with size() and operator[] yielding string views (see
+         *        argv_tokens_). 'match' maps a token to an option index (or npos_option) and
+         *        'store' receives (index, value). The value is a view into the token; it is
+         *        empty for flags.
+         *
+         *        The next token is either an option or content. Options are prefixed with
+         *        '-' or '--'. If the flag does not have any associated data then an
+         *        empty value is stored. A registered option that is the last token is
+         *        treated as a flag; the sequence is never read past its end. A negative
+         *        number ('-5') is content unless it is itself a registered option.
+         *
+         *        A token that is not a registered option is split where its shape allows (see
+         *        split_option_token_); the last flag of '-xvf' may take the next token as its
+         *        value. '--' ends the options; the tokens after it are ignored. A token in
+         *        option position that matches nothing is passed to 'unknown'.
+         *
+         *        If 'takes_list(index)' is true the option consumes every following token up to
+         *        the next option (e.g., '--inputs a b c'), storing each one.
+         */
+        template<typename Tokens, typename Match, typename Store, typename TakesList, typename Unknown>
+        void scan_command_line_tokens_(const Tokens &tokens, Match &&match, Store &&store, TakesList &&takes_list,
+                                       Unknown &&unknown) {
+            const std::size_t count = tokens.size();
+            const auto is_value = [&](const std::size_t i) {
+                if (i >= count) return false;
+                const std::string_view token = tokens[i];
+                const auto shape = classify_token_(token);
+                return token_kind_::value == shape.kind || (shape.numeric && npos_option == match(token));
+            };
+            const auto store_list = [&](const std::size_t index, std::size_t &i) {
+                if (!takes_list(index)) return;
+                while (is_value(i + 1)) store(index, strip_quotes_(tokens[++i]));
+            };
+            const auto store_option = [&](const std::size_t index, std::size_t &i) {
+                // The assumption here is that if content of an option begins with a '-' or '--', then the value
+                // of the option must be quoted.
+                //
+                // E.g.
+                // 		'-option "-Some Data"' Good
+                //		'-option -Some Data'   Bad
+                if (!is_value(i + 1)) {
+                    store(index, std::string_view{});
+                    return;
+                }
+                store(index, strip_quotes_(tokens[++i]));
+                store_list(index, i);
+            };
+
+            std::size_t i = 1;
+            for (; i < count; ++i) {
+                const std::string_view token = tokens[i];
+                const auto shape = classify_token_(token);
+                if (token_kind_::value == shape.kind) continue;
+                if (token_kind_::end_of_options == shape.kind) break;
+
+                const auto option = split_option_token_(token, shape, match, store, unknown);
+                if (npos_option == option.index) continue;
+                if (option.takes_value) store_option(option.index, i);
+                else store_list(option.index, i);
+            }
+            count_tokens_scanned_(count > 1 ? std::min(i, count - 1) : 0);
+        }
+
+        template<typename Tokens, typename Match, typename Store, typename TakesList>
+        void scan_command_line_tokens_(const Tokens &tokens, Match &&match, Store &&store, TakesList &&takes_list) {
+            scan_command_line_tokens_(tokens, std::forward<Match>(match), std::forward<Store>(store),
+                                      std::forward<TakesList>(takes_list), [](std::string_view) {});
+        }
+
+        template<typename Tokens, typename Match, typename Store>
+        void scan_command_line_tokens_(const Tokens &tokens, Match &&match, Store &&store) {
+            scan_command_line_tokens_(tokens, std::forward<Match>(match), std::forward<Store>(store),
+                                      [](std::size_t) { return false; });
+        }
+
+        /**
+         * \brief The names of an option table (a runtime_option_table_ or a command_line_schema)
+         *        behind a single type, for the parse extensions below.
+         */
+        class option_names_ final {
+        public:
+            template<typename OptionTable>
+            explicit option_names_(const OptionTable &options) noexcept
+                : options_(&options), size_(options.size()),
+                  long_name_([](const void *table, const std::size_t index) noexcept {
+                      return std::string_view(static_cast<const OptionTable *>(table)->long_name(index));
+                  }),
+                  short_name_([](const void *table, const std::size_t index) noexcept {
+                      return std::string_view(static_cast<const OptionTable *>(table)->short_name(index));
+                  }) {}
+
+            [[nodiscard]] std::size_t size() const noexcept { return size_; }
+            [[nodiscard]] std::string_view long_name(const std::size_t index) const noexcept { return long_name_(options_, index); }
+            [[nodiscard]] std::string_view short_name(const std::size_t index) const noexcept { return short_name_(options_, index); }
+
+        private:
+            const void *options_;
+            std::size_t size_;
+            std::string_view (*long_name_)(const void *, std::size_t) noexcept;
+            std::string_view (*short_name_)(const void *, std::size_t) noexcept;
+        };
+
+        /**
+         * \brief The tokens of an expanded command line and the storage that they view.
+         */
+        struct expanded_tokens_ final {
+            std::span<const std::string_view> tokens;
+            std::shared_ptr<const void> owner;
+        };
+
+        /**
+         * \brief The parse_mode features implemented by opt-in headers (see parse_mode). A header
+         *        installs its function during static initialization; a parse reads it once.
+         *
+         *        expand_response_files: <slx/cmd-line-response-files.hh>
+         *        suggest_option:        <slx/cmd-line-suggestions.hh>
+         *        resolve_abbreviation:  <slx/cmd-line-completions.hh>; resolves '--prefix' (given
+         *                               without the dashes) to an option, or returns npos_option
+         *                               and fills 'ambiguous' if several names start with it.
+         *                               'index' caches the lookup structure in the
+         *                               parser_context between parses.
+         */
+        struct parse_extensions_ final {
+            using expand_response_files_t = expanded_tokens_ (*)(int argc, char **argv);
+            using suggest_option_t = std::string (*)(const option_names_ &options, std::string_view token);
+            using resolve_abbreviation_t = std::size_t (*)(abbreviation_index_ &index,
+                                                           const option_names_ &options, std::string_view prefix,
+                                                           ambiguous_option_t &ambiguous);
+
+            std::atomic<expand_response_files_t> expand_response_files{};
+            std::atomic<suggest_option_t> suggest_option{};
+            std::atomic<resolve_abbreviation_t> resolve_abbreviation{};
+        };
+
+        inline parse_extensions_ &parse_extensions_instance_() {
+            static parse_extensions_ extensions;
+            return extensions;
+        }
+
+        /**
+         * \brief The installed extension 'Member' if 'mode' has 'flag', otherwise nullptr.
+         * @throw std::logic_error naming 'requirement' if 'mode' has 'flag' but the extension's
+         *        header is not part of the program (or not initialized yet; see parse_mode).
+         */
+        template<auto Member>
+        auto required_extension_(const parse_mode mode, const parse_mode flag, const char *const requirement) {
+            if (!has_parse_mode_(mode, flag)) return decltype((parse_extensions_instance_().*Member).load()){};
+            const auto extension = (parse_extensions_instance_().*Member).load(std::memory_order_acquire);
+            if (!extension) {
+                throw std::logic_error(std::string("slx: ") + requirement + " to be included (see slx::parse_mode)");
+            }
+            return extension;
+        }
+
+        /**
+         * \brief The installed response file expansion if 'mode' asks for one, otherwise nullptr.
+         */
+        inline parse_extensions_::expand_response_files_t response_files_expansion_(const parse_mode mode) {
+            return required_extension_<&parse_extensions_::expand_response_files>(
+                mode, parse_mode::response_files, "parse_mode::response_files requires <slx/cmd-line-response-files.hh>");
+        }
+
+        /**
+         * \brief response_files_expansion_ for a parse without a parser_context ('parser'), which
+         *        has nowhere to report unknown or ambiguous options.
+         * @throw std::invalid_argument if 'mode' asks for parse_mode::strict or abbreviations.
+         */
+        inline parse_extensions_::expand_response_files_t response_files_only_expansion_(const parse_mode mode,
+                                                                                          const char *const parser) {
+            if (has_parse_mode_(mode, parse_mode::strict) || has_parse_mode_(mode, parse_mode::abbreviations)) {
+                throw std::invalid_argument(std::string("slx: ") + parser +
+                                            " supports parse_mode::response_files only (see slx::parse_mode)");
+            }
+            return response_files_expansion_(mode);
+        }
+
+        /**
+         * \brief The shared implementation of parse_command_line_args for any option table and
+         *        token sequence. The results are stored in 'context'.
+         *
+         *        Presence is recorded in a bitset during the scan, so the required options are
+         *        checked against it (a word at a time for a schema's required mask) instead of
+         *        being looked up in the results, and every missing option is recorded.
+         *
+         *        With parse_mode::strict a token at an option position that matches nothing is
+         *        recorded as unknown; suggestions are computed only for those tokens, so a
+         *        command line without mistakes costs one extra comparison per option.
+         *
+         *        With parse_mode::abbreviations a '--' token that matches nothing is resolved
+         *        through a command_line_completions index of the long names. The index is
+         *        kept in 'context' and rebuilt only when a parse uses a different table.
+         */
+        template<bool include_app_path, typename OptionTable, typename Tokens>
+        command_line_options_result_t &parse_command_line_tokens_(parser_context &context, const OptionTable &options,
+                                                                  const Tokens &tokens,
+                                                                  const std::function<void()> &publish_help_info,
+                                                                  const parse_mode mode = parse_mode::none) {
+            [[maybe_unused]] const parse_timer_ timer;
+            auto &result = context.args();
+            if constexpr (include_app_path) {
+                if (tokens.size() > 0 && !tokens[0].empty()) result["app"] = tokens[0];
+            }
+
+            auto &unknown = context.unknown_options();
+            auto &ambiguous = context.ambiguous_options();
+            unknown.clear();
+            ambiguous.clear();
+            const auto strict = has_parse_mode_(mode, parse_mode::strict);
+            const auto suggest = required_extension_<&parse_extensions_::suggest_option>(
+                mode, parse_mode::strict, "parse_mode::strict requires <slx/cmd-line-suggestions.hh>");
+            const auto abbreviate = required_extension_<&parse_extensions_::resolve_abbreviation>(
+                mode, parse_mode::abbreviations, "parse_mode::abbreviations requires <slx/cmd-line-completions.hh>");
+            const option_names_ names(options);
+            auto &abbreviation_index = parser_context_access_::abbreviations(context);
+            abbreviation_index.checked = false;
+
+            const auto resolve = [&](const std::string_view token) {
+                auto index = options.match(token);
+                if (npos_option != index || !abbreviate || token.size() < 3 || !token.starts_with("--")) {
+                    return index;
+                }
+                ambiguous_option_t entry;
+                index = abbreviate(abbreviation_index, names, token.substr(2), entry);
+                if (0 != entry.candidate_count) {
+                    entry.token = token;
+                    ambiguous.push_back(std::move(entry));
+                }
+                return index;
+            };
+
+            // An ambiguous abbreviation is already reported; it is not also unknown.
+            auto reported = std::size_t{0};
+            option_bitset_ present(options.size());
+            [[maybe_unused]] const auto nodes = result.size();
+            [[maybe_unused]] const auto buckets = result.bucket_count();
+            scan_command_line_tokens_(tokens, resolve,
+                                      [&](const std::size_t index, const std::string_view value) {
+                                          present.set(index);
+                                          count_stored_strings_(options.long_name(index), value);
+                                          result[std::string(options.long_name(index))] = value;
+                                      },
+                                      [](std::size_t) { return false; },
+                                      [&](const std::string_view token) {
+                                          if (reported != ambiguous.size()) {
+                                              reported = ambiguous.size();
+                                              return;
+                                          }
+                                          if (strict) unknown.push_back({std::string(token), suggest(names, token)});
+                                      });
+            if constexpr (command_line_instrumentation) {
+                count_allocations_(result.size() - nodes + (result.bucket_count() != buckets ? 1 : 0));
+            }
+
+            // Record every missing required option and display help information if defined.
+            //
+            auto &missing = context.missing_options();
+            missing.clear();
+            for_each_missing_(present, options, [&](const std::size_t index) { missing.emplace_back(options.long_name(index)); });
+            if ((!missing.empty() || !unknown.empty() || !ambiguous.empty()) && publish_help_info) publish_help_info();
+            return result;
+        }
+
+        /**
+         * \brief parse_command_line_tokens_ over argc/argv, expanding response files if 'mode'
+         *        asks for it.
+         */
+        template<bool include_app_path, typename OptionTable>
+        command_line_options_result_t &parse_command_line_args_(parser_context &context, const OptionTable &options,
+                                                                const int argc, char **argv,
+                                                                const std::function<void()> &publish_help_info,
+                                                                const parse_mode mode = parse_mode::none) {
+            if (const auto expand = response_files_expansion_(mode)) {
+                const auto expanded = expand(argc, argv);
+                return parse_command_line_tokens_<include_app_path>(context, options, expanded.tokens,
+                                                                    publish_help_info, mode);
+            }
+            return parse_command_line_tokens_<include_app_path>(context, options, argv_tokens_(argc, argv),
+                                                                publish_help_info, mode);
         }
     }
 
@@ -145,7 +1146,12 @@ namespace slx {
     * \param argc The command line arg count.
     * \param argv The command line arguments.
     * \param publish_help_info A function to display help information to the user.
-    * \return A copy of the command_line_options_result_t, a std::unordered_map.
+    * \param mode Optional parse_mode flags; parse_mode::response_files expands '@file' tokens
+    *             (e.g., '@args.rsp') into the tokens of the file and parse_mode::strict reports
+    *             unregistered options (see get_unknown_command_line_options); see parse_mode for
+    *             the others.
+    * \return A copy of the command_line_options_result_t, a std::unordered_map. The results are
+    *         also published as the current command_line_snapshot().
     *
     *   The assumption here is that if content of an option begins with a '-' or '--', then the value of the option
     *   must be quoted.
@@ -204,93 +1210,44 @@ namespace slx {
     */
     template<bool include_app_path = true>
     command_line_options_result_t parse_command_line_args(command_line_options_t &options, int argc, char **argv,
-                                                          std::function<void()> publish_help_info) {
-        // Note:
-        // Compiling with C++ on Visual Studio results in 'cmd-line-parsing.hh(225,33):
-        // error C2672: 'get': no matching overloaded function found'
-        // error if 'std::get<long_option>'. The MSVC compiler errors on 'long_option', a
-        // constexpr and requires 'std::get<0>'. Therefore the #defines implemented in
-        // the code below.
-        //
-#ifdef WIN32
-#  define long_option  0
-#  define short_option 1
-#else
-        constexpr auto long_option = 0;
-        constexpr auto short_option = 1;
-#endif
-
-        const auto start = include_app_path ? 0 : 1;
-        std::string option;
-        auto &result = *get_command_line_args_();
-
-        for (auto i = start; i < argc; ++i) {
-            if constexpr(include_app_path)
-            {
-                if (0 == i) {
-                    result["app"] = argv[0];
-                    continue;
-                }
-            }
-            std::string arg = argv[i];
+                                                          std::function<void()> publish_help_info,
+                                                          const parse_mode mode = parse_mode::none) {
+        const auto &result = detail::parse_command_line_args_<include_app_path>(
+            global_parser_context(), detail::runtime_option_table_{options}, argc, argv, publish_help_info, mode);
+        publish_command_line_snapshot(result);
+        return result;
+    }
 
-            // tuple of <std::string, std::string, bool>:
-            //
-            // Where first string is long form of the option name and the second string
-            // is the short form of the options key. 'bool' is a flag that indicates
-            // if the option is required.
-            //
-            if (std::find_if(options.begin(), options.end(), [&](std::tuple<std::string, std::string, bool> &p) {
-                if (("--" + std::get<long_option>(p)) == arg || ("-" + std::get<short_option>(p)) == arg) {
-                    option = std::get<long_option>(p);
-                    return true;
-                }
-                return false;
-            }) != options.end()) {
-                // See if the next arg is an option or content. Options are prefixed with
-                // '-' or '--'. If the flag does not have any associated data then an
-                // empty string is assigned for content.
-                //
-                // The assumption here is that if content of an option begins with a '-' or '--', then the value
-                // of the option must be quoted.
-                //
-                // E.g.
-                // 		'-option "-Some Data"' Good
-                //		'-option -Some Data'   Bad
-                ++i;
-                if (argv[i]) {
-                    if ('-' == argv[i][0]) {
-                        result[option] = "";
-                        --i;
-                        continue;
-                    }
-                    result[option] = argv[i];
-
-                    // On some platforms (e.g., Windows, extra quotes are added to arguments
-                    // by the operating system). These are removed when storing the value.
-                    //
-                    if ('\"' == result[option].front() && '\"' == result[option].back()) {
-                        //
-                        // Remove the extra quotes around the string.
-                        //
-                        auto &t = result[option];
-                        result[option] = std::string(t.begin() + 1, t.end() - 1);
-                    }
-                }
-            }
-        }
+    /**
+     * \brief Reentrant form of parse_command_line_args. The results of any previous parse held by
+     *        'context' are discarded first so that every parse is isolated.
+     * @return The results owned by 'context'.
+     */
+    template<bool include_app_path = true>
+    const command_line_options_result_t &parse_command_line_args(parser_context &context,
+                                                                 const command_line_options_t &options, int argc,
+                                                                 char **argv,
+                                                                 const std::function<void()> &publish_help_info,
+                                                                 const parse_mode mode = parse_mode::none) {
+        context.clear();
+        return detail::parse_command_line_args_<include_app_path>(
+            context, detail::runtime_option_table_{options}, argc, argv, publish_help_info, mode);
+    }
 
-        // Evaluate if any options are missing and display help information if defined.
-        // This routine may also provide validation.
-        //
-        for (auto const &[key, ignore, is_required]: options) {
-            if (result.count(key)) continue;
-            if (is_required && publish_help_info) {
-                publish_help_info();
-                break;
-            }
-        }
-        return result;
+    /**
+     * \brief Reentrant parse of a command line that was split by command_line_tokens (e.g.,
+     *        one received as a single string).
+     * @return The results owned by 'context'.
+     */
+    template<bool include_app_path = true>
+    const command_line_options_result_t &parse_command_line_args(parser_context &context,
+                                                                 const command_line_options_t &options,
+                                                                 const command_line_tokens &tokens,
+                                                                 const std::function<void()> &publish_help_info,
+                                                                 const parse_mode mode = parse_mode::none) {
+        context.clear();
+        return detail::parse_command_line_tokens_<include_app_path>(
+            context, detail::runtime_option_table_{options}, tokens, publish_help_info, mode);
     }
 }
 
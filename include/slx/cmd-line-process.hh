@@ -0,0 +1,143 @@
+#pragma once
+#ifndef CMD_LINE_PROCESS_HH__
+#define CMD_LINE_PROCESS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-parsing.hh"
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <unistd.h>
+#elif defined(__APPLE__)
+#   include <crt_externs.h>
+#elif defined(_WIN32)
+#   include <cstdlib>
+#endif
+
+namespace slx {
+    /**
+     * \brief The arguments of the running process, available anywhere (including during static
+     *        initialization) without argc/argv being passed down from main.
+     *
+     *        On Linux /proc/self/cmdline is read into one buffer (a single read for any
+     *        command line that fits the first 4 KiB; procfs files cannot be mapped) and the
+     *        NUL separated arguments are used in place. macOS and Windows expose the
+     *        arguments of main through their C runtimes. Elsewhere the command line is empty.
+     *
+     *        E.g.,
+     *        const auto &process = slx::process_command_line::current();
+     *        slx::parse_command_line_args(context, options, process.argc(), process.argv(), help_info);
+     *
+     *        The arguments are read once, on the first call to current(), and are not changed
+     *        afterwards.
+     */
+    class process_command_line final {
+    public:
+        [[nodiscard]] static const process_command_line &current() {
+            static const process_command_line process;
+            return process;
+        }
+
+        process_command_line(const process_command_line &) = delete;
+        process_command_line &operator=(const process_command_line &) = delete;
+
+        [[nodiscard]] int argc() const noexcept { return static_cast<int>(argv_.size()) - 1; }
+
+        /**
+         * \brief A null terminated argv, as passed to main.
+         */
+        [[nodiscard]] char **argv() const noexcept { return const_cast<char **>(argv_.data()); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return argv_.size() - 1; }
+        [[nodiscard]] std::string_view operator[](const std::size_t index) const noexcept { return argv_[index]; }
+
+    private:
+        process_command_line() {
+#if defined(__linux__)
+            read_proc_cmdline_();
+            for (std::size_t begin = 0; begin < buffer_.size();) {
+                argv_.push_back(buffer_.data() + begin);
+                begin = buffer_.find('\0', begin) + 1;
+            }
+#elif defined(__APPLE__)
+            const auto argv = *_NSGetArgv();
+            argv_.assign(argv, argv + *_NSGetArgc());
+#elif defined(_WIN32)
+            if (nullptr != __argv) argv_.assign(__argv, __argv + __argc);
+#endif
+            argv_.push_back(nullptr);
+        }
+
+#if defined(__linux__)
+        void read_proc_cmdline_() {
+            const auto fd = ::open("/proc/self/cmdline", O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+
+            buffer_.resize(4096);
+            std::size_t size = 0;
+            for (;;) {
+                const auto n = ::read(fd, buffer_.data() + size, buffer_.size() - size);
+                if (n < 0 && EINTR == errno) continue;
+                if (n <= 0) break;
+                size += static_cast<std::size_t>(n);
+                if (size == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+            }
+            ::close(fd);
+
+            // Every argument ends with a NUL, unless the process rewrote its arguments.
+            buffer_.resize(size);
+            if (!buffer_.empty() && '\0' != buffer_.back()) buffer_.push_back('\0');
+        }
+
+        std::string buffer_;
+#endif
+        std::vector<char *> argv_;
+    };
+
+    /**
+     * \brief Registers a parse of the process command line (see process_command_line) into the
+     *        global results. It runs on the first access to them through
+     *        get_command_line_option, command_line_option, command_line_snapshot, etc., on
+     *        whichever thread gets there first, once; other threads wait for it.
+     *
+     *        E.g., in a shared library:
+     *        static const bool registered = [] {
+     *            slx::defer_command_line_parse({ {"threads", "j", false} });
+     *            return true;
+     *        }();
+     *        ...
+     *        auto threads = slx::get_command_line_option("threads");
+     *
+     *        Several libraries may each register their options (and help functions); a
+     *        registration after the first access runs on the next one. The results add to
+     *        those of any parse_command_line_args made by main. 'options' is copied, so it
+     *        may go out of scope before the first access.
+     */
+    template<bool include_app_path = true>
+    void defer_command_line_parse(command_line_options_t options, std::function<void()> publish_help_info = {},
+                                  const parse_mode mode = parse_mode::none) {
+        detail::defer_global_parse_([options = std::move(options), help = std::move(publish_help_info), mode]() mutable {
+            const auto &process = process_command_line::current();
+            parse_command_line_args<include_app_path>(options, process.argc(), process.argv(), help, mode);
+        });
+    }
+}
+
+#endif // CMD_LINE_PROCESS_HH__
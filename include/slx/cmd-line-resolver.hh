@@ -0,0 +1,395 @@
+#pragma once
+#ifndef CMD_LINE_RESOLVER_HH__
+#define CMD_LINE_RESOLVER_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-parsing.hh"
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <thread>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#endif
+
+// The environment is taken from the C runtime's declarations where there are any.
+//
+#if defined(_WIN32)
+#   include <cstdlib>
+#   define SLX_ENVIRON _environ
+#elif defined(__APPLE__)
+#   include <crt_externs.h>
+#   define SLX_ENVIRON (*_NSGetEnviron())
+#elif defined(__GLIBC__) && defined(_GNU_SOURCE) // declared by <unistd.h>
+#   define SLX_ENVIRON environ
+#else
+extern char **environ;
+#   define SLX_ENVIRON environ
+#endif
+
+namespace slx {
+    /**
+     * \brief The layer that supplied an option's value, lowest precedence first.
+     */
+    enum class option_source : std::uint8_t { none, config_file, environment, command_line };
+
+    /**
+     * \brief Resolves the options of a command_line_options_t from the command line, the
+     *        environment and a config file, in that order of precedence, and publishes the
+     *        merged results as the command_line_snapshot().
+     *
+     *        E.g.,
+     *        slx::command_line_resolver config(options, "MYAPP_", "/etc/myapp.conf");
+     *        config.resolve(argc, argv, help_info);
+     *        config.watch();    // reload when the file changes (Linux)
+     *        ...
+     *        auto threads = slx::command_line_snapshot()->at("threads");
+     *
+     *        Environment variables are named by the prefix and the long name in upper case with
+     *        '-' replaced by '_' (e.g., MYAPP_LOG_LEVEL for "log-level"); 'environ' is scanned
+     *        once. Without a prefix the environment layer is disabled, so that options such as
+     *        "path" or "home" do not pick up $PATH or $HOME. The config file holds one
+     *        'name = value' per line ("name" alone is a flag, quotes are stripped and lines
+     *        starting with '#' or ';' are comments); it is read in one streaming pass. Unknown
+     *        names are ignored.
+     *
+     *        A reload re-reads the config file and changes only the options whose merged value
+     *        changed; if none did nothing is published. A reload that fails changes nothing.
+     *        Readers never lock (see command_line_snapshot), and a reader holding a previous
+     *        snapshot keeps it.
+     */
+    class command_line_resolver final {
+    public:
+        explicit command_line_resolver(command_line_options_t options, std::string env_prefix = {},
+                                       std::string config_path = {})
+            : options_(std::move(options)), env_prefix_(std::move(env_prefix)), config_path_(std::move(config_path)),
+              command_line_(options_.size()), environment_(options_.size()), config_file_(options_.size()),
+              sources_(options_.size(), option_source::none) {
+            for (std::size_t i = 0; i < options_.size(); ++i) {
+                const auto &name = std::get<0>(options_[i]);
+                names_.emplace(name, i);
+                if (!env_prefix_.empty()) environment_names_.emplace(environment_name_(name), i);
+            }
+        }
+
+        ~command_line_resolver() { stop(); }
+
+        command_line_resolver(const command_line_resolver &) = delete;
+        command_line_resolver &operator=(const command_line_resolver &) = delete;
+
+        /**
+         * \brief Reads all three layers, publishes the merged results and calls
+         *        publish_help_info if a required option is in none of them.
+         * @return The published snapshot.
+         */
+        command_line_snapshot_t resolve(const int argc, char **argv, const std::function<void()> &publish_help_info) {
+            const std::lock_guard<std::mutex> lock(mutex_);
+
+            std::fill(command_line_.begin(), command_line_.end(), std::nullopt);
+            const detail::runtime_option_table_ table{options_};
+            const detail::argv_tokens_ tokens(argc, argv);
+            detail::scan_command_line_tokens_(tokens, [&](const std::string_view token) { return table.match(token); },
+                                              [&](const std::size_t index, const std::string_view value) {
+                                                  command_line_[index].emplace(value);
+                                              });
+            read_environment_();
+            config_file_ = read_config_file_();
+
+            command_line_options_result_t merged;
+            if (tokens.size() > 0 && !tokens[0].empty()) merged["app"] = tokens[0];
+            for (std::size_t i = 0; i < options_.size(); ++i) {
+                const auto [value, source] = merge_(i);
+                sources_[i] = source;
+                if (value) merged[std::get<0>(options_[i])] = *value;
+            }
+            publish_(std::make_shared<const command_line_options_result_t>(std::move(merged)));
+
+            for (std::size_t i = 0; i < options_.size(); ++i) {
+                if (!table.is_required(i) || option_source::none != sources_[i]) continue;
+                if (publish_help_info) {
+                    publish_help_info();
+                    break;
+                }
+            }
+            return current_;
+        }
+
+        /**
+         * \brief Re-reads the config file and publishes the options whose values changed.
+         *        The new layer and snapshot are built aside and committed only once complete,
+         *        so if this throws the previous layer and snapshot are kept.
+         * @return true if anything was published.
+         */
+        bool reload() {
+            const std::lock_guard<std::mutex> lock(mutex_);
+
+            auto config_file = read_config_file_();
+            auto sources = sources_;
+            std::optional<command_line_options_result_t> next;
+            for (std::size_t i = 0; i < options_.size(); ++i) {
+                if (config_file[i] == config_file_[i]) continue;
+
+                const auto [value, source] = merge_(i, config_file);
+                const auto &name = std::get<0>(options_[i]);
+                const auto it = detail::find_key_(*current_, name);
+                const auto unchanged = value ? (it != current_->end() && it->second == *value) : it == current_->end();
+                sources[i] = source;
+                if (unchanged) continue;
+
+                if (!next) next.emplace(*current_);
+                if (value) (*next)[name] = *value;
+                else next->erase(name);
+            }
+            auto snapshot = next ? std::make_shared<const command_line_options_result_t>(std::move(*next))
+                                 : command_line_snapshot_t{};
+
+            config_file_ = std::move(config_file);
+            sources_ = std::move(sources);
+            if (!snapshot) return false;
+            publish_(std::move(snapshot));
+            return true;
+        }
+
+        /**
+         * \brief Reloads the config file whenever it is written, created, replaced or removed,
+         *        from a background thread (inotify; Linux only).
+         *
+         *        A reload that throws keeps the previous layer and snapshot (see reload), and the
+         *        watcher keeps watching. The exception is passed to 'on_error' on the watcher
+         *        thread, or written to standard error if there is no 'on_error'.
+         * @return false if the file cannot be watched on this platform.
+         */
+        bool watch(std::function<void(std::exception_ptr)> on_error = {}) {
+#if defined(__linux__)
+            if (watcher_.joinable()) return true;
+            if (config_path_.empty()) return false;
+
+            const auto path = std::filesystem::path(config_path_);
+            const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+            const auto fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (fd < 0) return false;
+            if (::inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0 ||
+                (stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+                ::close(fd);
+                return false;
+            }
+            watcher_ = std::thread([this, fd, name = path.filename().string(), on_error = std::move(on_error)] {
+                watch_(fd, name, on_error);
+                ::close(fd);
+            });
+            return true;
+#else
+            (void)on_error;
+            return false;
+#endif
+        }
+
+        /**
+         * \brief Stops watching the config file.
+         */
+        void stop() noexcept {
+#if defined(__linux__)
+            if (!watcher_.joinable()) return;
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const auto written = ::write(stop_fd_, &one, sizeof(one));
+            watcher_.join();
+            ::close(stop_fd_);
+            stop_fd_ = -1;
+#endif
+        }
+
+        /**
+         * \brief The last snapshot published by this resolver (hot paths should read
+         *        command_line_snapshot() instead, which does not lock).
+         */
+        [[nodiscard]] command_line_snapshot_t snapshot() const {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            return current_;
+        }
+
+        /**
+         * \brief The layer that supplied the option's current value.
+         */
+        [[nodiscard]] option_source source(const std::string_view key) const {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = detail::find_key_(names_, key);
+            return it != names_.end() ? sources_[it->second] : option_source::none;
+        }
+
+    private:
+        using layer_t = std::vector<std::optional<std::string>>;
+        using index_t = std::unordered_map<std::string, std::size_t, detail::string_hash_, std::equal_to<>>;
+
+        [[nodiscard]] std::string environment_name_(const std::string_view name) const {
+            std::string result = env_prefix_;
+            for (const auto c: name) {
+                result += '-' == c ? '_' : ('a' <= c && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+            }
+            return result;
+        }
+
+        /**
+         * \brief One pass over 'environ' (none without a prefix).
+         */
+        void read_environment_() {
+            std::fill(environment_.begin(), environment_.end(), std::nullopt);
+            if (env_prefix_.empty()) return;
+            for (auto variable = SLX_ENVIRON; variable && *variable; ++variable) {
+                const std::string_view entry = *variable;
+                if (0 != entry.compare(0, env_prefix_.size(), env_prefix_)) continue;
+                const auto equals = entry.find('=');
+                if (std::string_view::npos == equals) continue;
+                const auto it = detail::find_key_(environment_names_, entry.substr(0, equals));
+                if (it != environment_names_.end()) environment_[it->second].emplace(entry.substr(equals + 1));
+            }
+        }
+
+        /**
+         * \brief One streaming pass over the config file (a missing file is an empty layer).
+         *        The file is streamed rather than mapped so that truncating it while it is
+         *        being read cannot fault.
+         * @throw std::ios_base::failure if the file could not be read to the end (a partial
+         *        read is not mistaken for a file without the remaining options).
+         */
+        [[nodiscard]] layer_t read_config_file_() const {
+            layer_t layer(options_.size());
+            if (config_path_.empty()) return layer;
+
+            std::ifstream ifs(config_path_);
+            constexpr std::string_view space = " \t\r";
+            std::string line;
+            while (std::getline(ifs, line)) {
+                std::string_view text = line;
+                text.remove_prefix(std::min(text.find_first_not_of(space), text.size()));
+                if (text.empty() || '#' == text.front() || ';' == text.front()) continue;
+
+                const auto equals = text.find('=');
+                auto name = text.substr(0, equals);
+                auto value = std::string_view::npos == equals ? std::string_view{} : text.substr(equals + 1);
+                name = name.substr(0, name.find_last_not_of(space) + 1);
+                while (!name.empty() && '-' == name.front()) name.remove_prefix(1);
+                value.remove_prefix(std::min(value.find_first_not_of(space), value.size()));
+                value = value.substr(0, value.find_last_not_of(space) + 1);
+
+                const auto it = detail::find_key_(names_, name);
+                if (it != names_.end()) layer[it->second].emplace(detail::strip_quotes_(value));
+            }
+            if (ifs.bad()) throw std::ios_base::failure("slx: unable to read " + config_path_);
+            return layer;
+        }
+
+        [[nodiscard]] std::pair<const std::string *, option_source> merge_(const std::size_t i,
+                                                                           const layer_t &config_file) const {
+            if (command_line_[i]) return {&*command_line_[i], option_source::command_line};
+            if (environment_[i]) return {&*environment_[i], option_source::environment};
+            if (config_file[i]) return {&*config_file[i], option_source::config_file};
+            return {nullptr, option_source::none};
+        }
+
+        [[nodiscard]] std::pair<const std::string *, option_source> merge_(const std::size_t i) const {
+            return merge_(i, config_file_);
+        }
+
+        void publish_(command_line_snapshot_t next) {
+            current_ = std::move(next);
+            publish_command_line_snapshot(current_);
+        }
+
+#if defined(__linux__)
+        void watch_(const int fd, const std::string &name, const std::function<void(std::exception_ptr)> &on_error) {
+            alignas(inotify_event) char buffer[4096];
+            pollfd fds[2] = {{fd, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+            for (;;) {
+                if (::poll(fds, 2, -1) < 0) {
+                    if (EINTR == errno) continue;
+                    return;
+                }
+                if (fds[1].revents) return;
+
+                auto relevant = false;
+                for (;;) {
+                    const auto n = ::read(fd, buffer, sizeof(buffer));
+                    if (n <= 0) break;
+                    for (auto p = buffer; p < buffer + n;) {
+                        const auto event = reinterpret_cast<const inotify_event *>(p);
+                        if (event->len && name == event->name) relevant = true;
+                        p += sizeof(inotify_event) + event->len;
+                    }
+                }
+                if (relevant) reload_from_watcher_(on_error);
+            }
+        }
+
+        /**
+         * \brief reload, with its exception reported instead of ending the watcher thread
+         *        (which would terminate the process).
+         */
+        void reload_from_watcher_(const std::function<void(std::exception_ptr)> &on_error) noexcept {
+            try {
+                reload();
+            } catch (...) {
+                const auto error = std::current_exception();
+                try {
+                    if (on_error) on_error(error);
+                    else report_reload_error_(error);
+                } catch (...) {
+                    // An error handler that throws is ignored; the watcher keeps running.
+                }
+            }
+        }
+
+        void report_reload_error_(const std::exception_ptr &error) const {
+            command_line_output out(output_stream::standard_error);
+            out << "slx: reloading " << config_path_ << " failed";
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception &e) {
+                out << ": " << e.what();
+            } catch (...) {
+            }
+            out << "\n";
+        }
+#endif
+
+        command_line_options_t options_;
+        std::string env_prefix_;
+        std::string config_path_;
+        index_t names_;
+        index_t environment_names_;
+        layer_t command_line_;
+        layer_t environment_;
+        layer_t config_file_;
+        std::vector<option_source> sources_;
+        command_line_snapshot_t current_{std::make_shared<const command_line_options_result_t>()};
+        mutable std::mutex mutex_;
+        std::thread watcher_;
+        int stop_fd_{-1};
+    };
+}
+
+#undef SLX_ENVIRON
+
+#endif // CMD_LINE_RESOLVER_HH__
@@ -0,0 +1,160 @@
+#pragma once
+#ifndef CMD_LINE_RESPONSE_FILES_HH__
+#define CMD_LINE_RESPONSE_FILES_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+// Opt-in: including this header in any translation unit of the program enables
+// parse_mode::response_files (see parse_mode).
+//
+#include "cmd-line-parsing.hh"
+#include "cmd-line-mapped-file.hh"
+#include "cmd-line-tokenizer.hh"
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace slx {
+    /**
+     * \brief The command line with every '@file' token replaced by the tokens of the response file.
+     *
+     *        E.g.,
+     *        slx::command_line_expansion expansion;
+     *        expansion.expand(argc, argv);
+     *        for (std::string_view token : expansion) { ... }
+     *
+     *        Response files are mapped copy on write and tokenized in place (see
+     *        tokenize_in_place_), so the tokens are views into the mappings and are valid for the
+     *        lifetime of the expansion. Response files may name other response files up to
+     *        'max_depth' levels deep, but not themselves: a file that is already being expanded
+     *        (e.g., '@self' inside self, or 'a' naming 'b' naming 'a') is not entered again. A
+     *        response file that cannot be opened, is nested too deeply or names itself is kept as
+     *        a literal token and reported by failures(). The expansion stops adding tokens at
+     *        'max_tokens', and the file that reached the limit is reported too.
+     */
+    class command_line_expansion final {
+    public:
+        static constexpr unsigned default_max_depth = 16;
+        static constexpr std::size_t default_max_tokens = std::size_t{1} << 20;
+
+        void expand(const int argc, char **argv, const unsigned max_depth = default_max_depth,
+                    const std::size_t max_tokens = default_max_tokens) {
+            clear();
+            max_tokens_ = max_tokens;
+            tokens_.reserve(argc > 0 ? static_cast<std::size_t>(argc) : 0);
+            for (auto i = 0; i < argc; ++i) {
+                const std::string_view token = argv[i] ? argv[i] : "";
+                // argv[0] is the application path and is never expanded.
+                //
+                if (i > 0 && is_response_file_(token)) expand_file_(token, max_depth);
+                else tokens_.push_back(token);
+            }
+        }
+
+        void clear() noexcept {
+            files_.clear();
+            tokens_.clear();
+            failures_.clear();
+            active_.clear();
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return tokens_.size(); }
+        [[nodiscard]] std::string_view operator[](const std::size_t i) const noexcept { return tokens_[i]; }
+        [[nodiscard]] auto begin() const noexcept { return tokens_.begin(); }
+        [[nodiscard]] auto end() const noexcept { return tokens_.end(); }
+
+        /**
+         * \brief The response files that could not be opened, were nested too deeply, named
+         *        themselves or reached the token limit.
+         */
+        [[nodiscard]] const std::vector<std::string> &failures() const noexcept { return failures_; }
+
+    private:
+        static bool is_response_file_(const std::string_view token) noexcept {
+            return token.size() > 1 && '@' == token.front();
+        }
+
+        /**
+         * \brief The path that identifies a response file on the expansion stack; the path as
+         *        given if it cannot be resolved.
+         */
+        static std::string canonical_path_(const std::string &path) {
+            std::error_code error;
+            auto canonical = std::filesystem::weakly_canonical(path, error);
+            return error ? path : canonical.string();
+        }
+
+        void push_token_(const std::string_view token, bool &truncated) {
+            if (tokens_.size() < max_tokens_) tokens_.push_back(token);
+            else truncated = true;
+        }
+
+        void expand_file_(const std::string_view token, const unsigned depth) {
+            const std::string path(token.substr(1));
+            auto canonical = canonical_path_(path);
+            const auto reentered = std::find(active_.begin(), active_.end(), canonical) != active_.end();
+            mapped_file file;
+            if (0 == depth || reentered || tokens_.size() >= max_tokens_ ||
+                !file.open(path, mapped_file::access::copy_on_write)) {
+                failures_.push_back(path);
+                if (tokens_.size() < max_tokens_) tokens_.push_back(token);
+                return;
+            }
+
+            files_.push_back(std::move(file));
+            active_.push_back(std::move(canonical));
+            auto &mapping = files_.back();
+            auto truncated = false;
+            detail::tokenize_in_place_(mapping.data(), mapping.data() + mapping.size(), [&](const std::string_view t) {
+                if (is_response_file_(t) && !truncated) expand_file_(t, depth - 1);
+                else push_token_(t, truncated);
+            });
+            active_.pop_back();
+            if (truncated) failures_.push_back(path);
+        }
+
+        std::deque<mapped_file> files_;
+        std::vector<std::string_view> tokens_;
+        std::vector<std::string> failures_;
+        std::vector<std::string> active_;   // the canonical paths of the files being expanded
+        std::size_t max_tokens_{default_max_tokens};
+    };
+
+    namespace detail {
+        /**
+         * \brief Expands argc/argv into tokens owned by a shared command_line_expansion.
+         */
+        inline expanded_tokens_ expand_response_files_(const int argc, char **argv) {
+            auto expansion = std::make_shared<command_line_expansion>();
+            expansion->expand(argc, argv);
+            const std::span<const std::string_view> tokens(expansion->begin(), expansion->end());
+            return {tokens, std::move(expansion)};
+        }
+
+        inline const bool response_files_installed_ = [] {
+            parse_extensions_instance_().expand_response_files.store(&expand_response_files_, std::memory_order_release);
+            return true;
+        }();
+    }
+}
+
+#endif // CMD_LINE_RESPONSE_FILES_HH__
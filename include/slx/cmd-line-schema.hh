@@ -0,0 +1,330 @@
+#pragma once
+#ifndef CMD_LINE_SCHEMA_HH__
+#define CMD_LINE_SCHEMA_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-parsing.hh"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace slx {
+    /**
+     * \brief The type of an option's value. Typed values are converted once, when the command
+     *        line is parsed (see command_line_views::get).
+     *
+     *        integer:        64 bit signed (decimal, or hexadecimal with a '0x' prefix)
+     *        floating_point: double
+     *        boolean:        true/false, yes/no, on/off, 1/0; a flag without a value is true
+     *        duration:       a number with an optional ns, us, ms, s, m, h or d suffix (s if omitted)
+     *        byte_size:      a number with an optional K, M, G or T suffix (powers of 1024)
+     *        enumeration:    one of the option's '|' separated choices
+     */
+    enum class option_type : std::uint8_t {
+        string, integer, floating_point, boolean, duration, byte_size, enumeration
+    };
+
+    /**
+     * \brief How many values an option takes (see command_line_lists).
+     *
+     *        single:   one value; when repeated the last one is kept
+     *        repeated: one value per occurrence, e.g., '-I a -I b'
+     *        multiple: every value up to the next option, e.g., '--inputs a b c' (may also repeat)
+     */
+    enum class option_arity : std::uint8_t { single, repeated, multiple };
+
+    /**
+     * \brief Describes a single option of a command_line_schema.
+     *
+     *        E.g.,
+     *        constexpr slx::option_spec in{ "in", "i", true };  // long, short, required
+     *        constexpr slx::option_spec threads{ "threads", "j", false, slx::option_type::integer };
+     *        constexpr slx::option_spec mode{ "mode", "m", false, slx::option_type::enumeration, "fast|safe" };
+     *        constexpr slx::option_spec include{ "include", "I", false, {}, {}, slx::option_arity::repeated };
+     *
+     *        The names must refer to storage that outlives the schema (string literals
+     *        are the usual case).
+     */
+    struct option_spec final {
+        std::string_view long_name{};
+        std::string_view short_name{};
+        bool required{};
+        option_type type{option_type::string};
+        std::string_view choices{};
+        option_arity arity{option_arity::single};
+    };
+
+    namespace detail {
+        /**
+         * \brief Re-mixes a name hash with a displacement (splitmix64 finalizer).
+         */
+        constexpr std::uint64_t mix_option_hash_(std::uint64_t h, const std::uint64_t seed) noexcept {
+            h += seed * 0x9e3779b97f4a7c15ull;
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+            return h ^ (h >> 31);
+        }
+
+        constexpr std::size_t ceil_pow2_(const std::size_t n) noexcept {
+            std::size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+    }
+
+    /**
+     * \brief A compile time alternative to command_line_options_t.
+     *
+     *        E.g.,
+     *        constexpr auto options = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+     *        auto cmd_line = slx::parse_command_line_args(options, argc, argv, [](){});
+     *
+     *        The long and short spellings of every option are placed in a perfect hash table
+     *        (hash and displace) when the schema is constructed, so matching a token costs one
+     *        hash of the token, one probe and one compare; nothing is allocated. Duplicate
+     *        names are rejected (a compile error when the schema is constexpr).
+     */
+    template<std::size_t N>
+    class command_line_schema final {
+        static_assert(N > 0, "A command line schema requires at least one option.");
+
+        static constexpr std::size_t key_capacity = 2 * N;
+        static constexpr std::size_t slot_count = detail::ceil_pow2_(2 * key_capacity);
+        static constexpr std::size_t bucket_count = detail::ceil_pow2_(N);
+        static constexpr std::uint64_t max_displacement = 1u << 20;
+
+    public:
+        static constexpr std::size_t npos = detail::npos_option;
+
+        constexpr explicit command_line_schema(const option_spec (&options)[N]) {
+            for (std::size_t i = 0; i < N; ++i) options_[i] = options[i];
+            build_();
+        }
+
+        constexpr explicit command_line_schema(const std::array<option_spec, N> &options) : options_(options) {
+            build_();
+        }
+
+        [[nodiscard]] constexpr std::size_t size() const noexcept { return N; }
+        [[nodiscard]] constexpr const option_spec &operator[](const std::size_t index) const noexcept { return options_[index]; }
+        [[nodiscard]] constexpr auto begin() const noexcept { return options_.begin(); }
+        [[nodiscard]] constexpr auto end() const noexcept { return options_.end(); }
+
+        [[nodiscard]] constexpr std::string_view long_name(const std::size_t index) const noexcept { return options_[index].long_name; }
+        [[nodiscard]] constexpr std::string_view short_name(const std::size_t index) const noexcept { return options_[index].short_name; }
+        [[nodiscard]] constexpr bool is_required(const std::size_t index) const noexcept { return options_[index].required; }
+        [[nodiscard]] constexpr option_type type(const std::size_t index) const noexcept { return options_[index].type; }
+        [[nodiscard]] constexpr option_arity arity(const std::size_t index) const noexcept { return options_[index].arity; }
+
+        /**
+         * \brief One bit per option, set for the required options.
+         */
+        [[nodiscard]] constexpr std::span<const std::uint64_t> required_mask() const noexcept { return required_; }
+
+        /**
+         * \brief The index of the option named 'name' (without dashes), otherwise npos.
+         */
+        [[nodiscard]] constexpr std::size_t find_long(const std::string_view name) const noexcept { return find_(name, true); }
+        [[nodiscard]] constexpr std::size_t find_short(const std::string_view name) const noexcept { return find_(name, false); }
+
+        /**
+         * \brief Maps '--long' or '-short' to the index of the option, otherwise npos.
+         */
+        [[nodiscard]] constexpr std::size_t match(const std::string_view token) const noexcept {
+            if (token.size() < 2 || '-' != token[0]) return npos;
+            return '-' == token[1] ? find_(token.substr(2), true) : find_(token.substr(1), false);
+        }
+
+    private:
+        // A slot holds ((option index << 1) | is_short) + 1; zero marks an empty slot.
+        //
+        [[nodiscard]] constexpr std::size_t find_(const std::string_view name, const bool is_long) const noexcept {
+            if (name.empty()) return npos;
+            const auto code = slots_[slot_of_(detail::hash_option_name_(name, is_long))];
+            if (0 == code) return npos;
+            const auto index = static_cast<std::size_t>((code - 1) >> 1);
+            const auto is_short = 0 != ((code - 1) & 1u);
+            if (is_short == is_long) return npos;
+            if (!std::is_constant_evaluated()) detail::count_name_comparisons_(1);
+            return name == (is_long ? options_[index].long_name : options_[index].short_name) ? index : npos;
+        }
+
+        [[nodiscard]] constexpr std::size_t slot_of_(const std::uint64_t h) const noexcept {
+            const auto d = displacement_[detail::mix_option_hash_(h, 0) & (bucket_count - 1)];
+            if (d < 0) return static_cast<std::size_t>(-(d + 1));
+            return detail::mix_option_hash_(h, static_cast<std::uint64_t>(d)) & (slot_count - 1);
+        }
+
+        constexpr void build_() {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (options_[i].required) required_[i / 64] |= std::uint64_t{1} << (i % 64);
+            }
+
+            std::array<std::uint64_t, key_capacity> hashes{};
+            std::array<std::uint32_t, key_capacity> codes{};
+            std::size_t key_count = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                if (!options_[i].long_name.empty()) {
+                    hashes[key_count] = detail::hash_option_name_(options_[i].long_name, true);
+                    codes[key_count++] = static_cast<std::uint32_t>((i << 1) + 1);
+                }
+                if (!options_[i].short_name.empty()) {
+                    hashes[key_count] = detail::hash_option_name_(options_[i].short_name, false);
+                    codes[key_count++] = static_cast<std::uint32_t>((i << 1 | 1u) + 1);
+                }
+            }
+
+            // Group the keys by bucket (counting sort).
+            //
+            std::array<std::size_t, bucket_count + 1> first{};
+            std::array<std::size_t, key_capacity> keys{};
+            for (std::size_t k = 0; k < key_count; ++k) ++first[bucket_of_(hashes[k]) + 1];
+            std::size_t largest = 0;
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                largest = first[b + 1] > largest ? first[b + 1] : largest;
+                first[b + 1] += first[b];
+            }
+            std::array<std::size_t, bucket_count> fill{};
+            for (std::size_t k = 0; k < key_count; ++k) {
+                const auto b = bucket_of_(hashes[k]);
+                keys[first[b] + fill[b]++] = k;
+            }
+
+            // Place the largest buckets first; each gets the first displacement that sends all
+            // of its keys to free slots. Single key buckets take any free slot directly.
+            //
+            std::size_t next_free = 0;
+            for (auto size = largest; size > 0; --size) {
+                for (std::size_t b = 0; b < bucket_count; ++b) {
+                    if (first[b + 1] - first[b] != size) continue;
+
+                    if (1 == size) {
+                        while (0 != slots_[next_free]) ++next_free;
+                        slots_[next_free] = codes[keys[first[b]]];
+                        displacement_[b] = -static_cast<std::int32_t>(next_free + 1);
+                        continue;
+                    }
+
+                    for (auto k = first[b]; k < first[b + 1]; ++k) {
+                        for (auto j = k + 1; j < first[b + 1]; ++j) {
+                            if (name_of_(codes[keys[k]]) == name_of_(codes[keys[j]]) &&
+                                ((codes[keys[k]] - 1) & 1u) == ((codes[keys[j]] - 1) & 1u)) {
+                                throw std::invalid_argument("command_line_schema: duplicate option name");
+                            }
+                        }
+                    }
+
+                    std::uint64_t d = 1;
+                    for (; d < max_displacement; ++d) {
+                        if (try_place_(hashes, codes, keys, first[b], first[b + 1], d)) break;
+                    }
+                    if (max_displacement == d) throw std::logic_error("command_line_schema: unable to build the hash table");
+                    displacement_[b] = static_cast<std::int32_t>(d);
+                }
+            }
+        }
+
+        [[nodiscard]] constexpr bool try_place_(const std::array<std::uint64_t, key_capacity> &hashes,
+                                                const std::array<std::uint32_t, key_capacity> &codes,
+                                                const std::array<std::size_t, key_capacity> &keys,
+                                                const std::size_t from, const std::size_t to, const std::uint64_t d) {
+            for (auto k = from; k < to; ++k) {
+                const auto slot = detail::mix_option_hash_(hashes[keys[k]], d) & (slot_count - 1);
+                if (0 != slots_[slot]) {
+                    for (auto j = from; j < k; ++j) slots_[detail::mix_option_hash_(hashes[keys[j]], d) & (slot_count - 1)] = 0;
+                    return false;
+                }
+                slots_[slot] = codes[keys[k]];
+            }
+            return true;
+        }
+
+        [[nodiscard]] static constexpr std::size_t bucket_of_(const std::uint64_t h) noexcept {
+            return detail::mix_option_hash_(h, 0) & (bucket_count - 1);
+        }
+
+        [[nodiscard]] constexpr std::string_view name_of_(const std::uint32_t code) const noexcept {
+            const auto &option = options_[(code - 1) >> 1];
+            return (code - 1) & 1u ? option.short_name : option.long_name;
+        }
+
+        std::array<option_spec, N> options_{};
+        std::array<std::uint32_t, slot_count> slots_{};
+        std::array<std::int32_t, bucket_count> displacement_{};
+        std::array<std::uint64_t, (N + 63) / 64> required_{};
+    };
+
+    /**
+     * \brief Builds a command_line_schema from a braced list of options.
+     *
+     *        E.g.,
+     *        constexpr auto options = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+     */
+    template<std::size_t N>
+    constexpr command_line_schema<N> make_command_line_schema(const option_spec (&options)[N]) {
+        return command_line_schema<N>(options);
+    }
+
+    /**
+     * \brief Same as parse_command_line_args for command_line_options_t but uses the
+     *        schema's perfect hash to match tokens (O(1), no allocations per token).
+     */
+    template<bool include_app_path = true, std::size_t N>
+    command_line_options_result_t parse_command_line_args(const command_line_schema<N> &options, int argc, char **argv,
+                                                          std::function<void()> publish_help_info,
+                                                          const parse_mode mode = parse_mode::none) {
+        const auto &result = detail::parse_command_line_args_<include_app_path>(global_parser_context(), options,
+                                                                                argc, argv, publish_help_info, mode);
+        publish_command_line_snapshot(result);
+        return result;
+    }
+
+    /**
+     * \brief Reentrant form of parse_command_line_args for a command_line_schema (see parser_context).
+     */
+    template<bool include_app_path = true, std::size_t N>
+    const command_line_options_result_t &parse_command_line_args(parser_context &context,
+                                                                 const command_line_schema<N> &options, int argc,
+                                                                 char **argv,
+                                                                 const std::function<void()> &publish_help_info,
+                                                                 const parse_mode mode = parse_mode::none) {
+        context.clear();
+        return detail::parse_command_line_args_<include_app_path>(context, options, argc, argv, publish_help_info,
+                                                                  mode);
+    }
+
+    /**
+     * \brief Reentrant parse of a command line split by command_line_tokens, for a schema.
+     */
+    template<bool include_app_path = true, std::size_t N>
+    const command_line_options_result_t &parse_command_line_args(parser_context &context,
+                                                                 const command_line_schema<N> &options,
+                                                                 const command_line_tokens &tokens,
+                                                                 const std::function<void()> &publish_help_info,
+                                                                 const parse_mode mode = parse_mode::none) {
+        context.clear();
+        return detail::parse_command_line_tokens_<include_app_path>(context, options, tokens, publish_help_info,
+                                                                    mode);
+    }
+}
+
+#endif // CMD_LINE_SCHEMA_HH__
@@ -0,0 +1,156 @@
+#pragma once
+#ifndef CMD_LINE_STREAM_HH__
+#define CMD_LINE_STREAM_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-schema.hh"
+
+namespace slx {
+    /**
+     * \brief A push style parser for a command line that arrives one token at a time (e.g.,
+     *        commands read from a pipe). Tokens are matched against a command_line_schema with
+     *        the semantics of parse_command_line_args, and each (option, value) pair is passed
+     *        to 'emit' as soon as it is decided:
+     *
+     *        - a value is emitted with the token that follows its option (quotes stripped);
+     *        - an option followed by another option, or by nothing, is emitted with an empty
+     *          value by the next feed or by finish;
+     *        - '--name=value', '-nvalue' and the leading flags of '-xvf' are emitted with the
+     *          token that carries them, and a negative number ('-5') is a value, as
+     *          scan_command_line_tokens_ splits them;
+     *        - an option of arity 'multiple' is emitted once per value that follows it, as
+     *          parse_command_line_lists records them;
+     *        - '--' ends the options; the tokens fed after it are ignored until finish.
+     *
+     *        E.g.,
+     *        constexpr auto options = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+     *        slx::command_line_stream session(options);
+     *        const auto emit = [&](std::size_t option, std::string_view value) { ... };
+     *        while (read_token(token)) session.feed(token, emit);
+     *        if (!session.finish(emit)) help_info();
+     *
+     *        There is no application token (argv[0]). The state is the schema, the pending
+     *        option and one bit per option, which finish checks against the schema's required
+     *        mask a word at a time; no tokens are buffered and the emitted views refer to the
+     *        token being fed. Tokens that name no option and follow no option are ignored.
+     */
+    template<std::size_t N>
+    class command_line_stream final {
+    public:
+        explicit command_line_stream(const command_line_schema<N> &schema) : schema_(&schema), seen_(N) {}
+
+        [[nodiscard]] const command_line_schema<N> &schema() const noexcept { return *schema_; }
+
+        /**
+         * \brief Consumes one token; 'emit(std::size_t option, std::string_view value)' is called
+         *        for the pair the token decides, if any.
+         */
+        template<typename Emit>
+        void feed(const std::string_view token, Emit &&emit) {
+            if (finished_) reset();
+            if (ended_) return;
+
+            const auto match = [&](const std::string_view t) { return schema_->match(t); };
+            const auto shape = detail::classify_token_(token);
+            const auto is_value = detail::token_kind_::value == shape.kind ||
+                                  (shape.numeric && detail::npos_option == match(token));
+            if (none_ != pending_) {
+                const std::size_t index = pending_;
+                if (is_value) {
+                    // An option that takes a list stays pending for the values that follow.
+                    if (option_arity::multiple == schema_->arity(index)) collecting_ = true;
+                    else pending_ = none_;
+                    emit(index, detail::strip_quotes_(token));
+                    return;
+                }
+                if (!collecting_) emit(index, std::string_view{});
+                pending_ = none_;
+                collecting_ = false;
+            }
+
+            if (is_value) return;
+            if (detail::token_kind_::end_of_options == shape.kind) {
+                ended_ = true;
+                return;
+            }
+
+            const auto store = [&](const std::size_t index, const std::string_view value) {
+                seen_.set(index);
+                emit(index, value);
+            };
+            const auto option = detail::split_option_token_(token, shape, match, store, [](std::string_view) {});
+            if (detail::npos_option == option.index) return;
+            seen_.set(option.index);
+
+            // An option that carried its value takes the tokens that follow only as a list.
+            if (!option.takes_value && option_arity::multiple != schema_->arity(option.index)) return;
+            pending_ = static_cast<std::uint32_t>(option.index);
+            collecting_ = !option.takes_value;
+        }
+
+        /**
+         * \brief Ends the command line: emits a pending option without a value and checks that
+         *        every required option was present. The next feed starts a new command line.
+         * @return false if a required option is missing (see missing).
+         */
+        template<typename Emit>
+        bool finish(Emit &&emit) {
+            if (none_ != pending_ && !collecting_) emit(static_cast<std::size_t>(pending_), std::string_view{});
+            pending_ = none_;
+            collecting_ = false;
+            ended_ = false;
+            finished_ = true;
+
+            auto complete = true;
+            detail::for_each_missing_(seen_, *schema_, [&](std::size_t) { complete = false; });
+            return complete;
+        }
+
+        /**
+         * \brief true if the option at 'index' is required and has not been seen (in the last
+         *        finished command line, until the next feed).
+         */
+        [[nodiscard]] bool missing(const std::size_t index) const noexcept {
+            return schema_->is_required(index) && !seen_.test(index);
+        }
+
+        /**
+         * \brief Discards the current command line.
+         */
+        void reset() noexcept {
+            pending_ = none_;
+            collecting_ = false;
+            ended_ = false;
+            finished_ = false;
+            seen_.reset();
+        }
+
+    private:
+        static constexpr std::uint32_t none_ = 0xffffffff;
+
+        const command_line_schema<N> *schema_;
+        std::uint32_t pending_{none_};
+        bool collecting_{};
+        bool ended_{};
+        bool finished_{};
+        detail::option_bitset_ seen_;
+    };
+}
+
+#endif // CMD_LINE_STREAM_HH__
@@ -0,0 +1,278 @@
+#pragma once
+#ifndef CMD_LINE_SUBCOMMANDS_HH__
+#define CMD_LINE_SUBCOMMANDS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-views.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace slx {
+    namespace detail {
+        /**
+         * \brief A string literal usable as a template argument (the name of a subcommand).
+         */
+        template<std::size_t N>
+        struct fixed_name_ final {
+            char value[N]{};
+
+            constexpr fixed_name_(const char (&name)[N]) noexcept { std::copy_n(name, N, value); }
+
+            [[nodiscard]] constexpr std::string_view view() const noexcept { return {value, N - 1}; }
+        };
+
+        /**
+         * \brief A trie of the subcommand names, built at compile time. Each node keeps its first
+         *        child and next sibling, so a lookup follows one edge per character of the token.
+         */
+        template<std::size_t Capacity>
+        class subcommand_trie_ final {
+            static_assert(Capacity < 0xffff, "Too many subcommand name characters.");
+
+        public:
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+            constexpr void insert(const std::string_view name, const std::size_t command) {
+                if (name.empty()) throw std::invalid_argument("command_line_subcommands: empty subcommand name");
+
+                std::uint16_t n = 0;
+                for (const auto c: name) {
+                    auto k = nodes_[n].child;
+                    while (none_ != k && c != nodes_[k].c) k = nodes_[k].sibling;
+                    if (none_ == k) {
+                        k = static_cast<std::uint16_t>(size_++);
+                        nodes_[k].c = c;
+                        nodes_[k].sibling = nodes_[n].child;
+                        nodes_[n].child = k;
+                    }
+                    n = k;
+                }
+                if (none_ != nodes_[n].command) throw std::invalid_argument("command_line_subcommands: duplicate subcommand name");
+                nodes_[n].command = static_cast<std::uint16_t>(command);
+            }
+
+            [[nodiscard]] constexpr std::size_t find(const std::string_view name) const noexcept {
+                std::uint16_t n = 0;
+                for (const auto c: name) {
+                    auto k = nodes_[n].child;
+                    while (none_ != k && c != nodes_[k].c) k = nodes_[k].sibling;
+                    if (none_ == k) return npos;
+                    n = k;
+                }
+                return none_ != nodes_[n].command ? nodes_[n].command : npos;
+            }
+
+        private:
+            static constexpr std::uint16_t none_ = 0xffff;
+
+            struct node_ final {
+                char c{};
+                std::uint16_t child{none_};
+                std::uint16_t sibling{none_};
+                std::uint16_t command{none_};
+            };
+
+            std::array<node_, Capacity> nodes_{};
+            std::size_t size_{1};
+        };
+    }
+
+    /**
+     * \brief A subcommand (see subcommand): its schema is built by 'make_schema' only when
+     *        the subcommand is selected, and 'run' receives the parsed views.
+     */
+    template<detail::fixed_name_ Name, typename MakeSchema, typename Run>
+    class subcommand_t final {
+    public:
+        static constexpr std::string_view name = Name.view();
+
+        subcommand_t(MakeSchema make_schema, Run run, std::function<void()> publish_help_info)
+            : make_schema_(std::move(make_schema)), run_(std::move(run)), publish_help_info_(std::move(publish_help_info)) {}
+
+        /**
+         * \brief Parses the arguments that follow the subcommand ('argv[0]' is the subcommand,
+         *        so it is the views' "app") and runs it.
+         * @return The result of 'run', or EXIT_FAILURE if the options are invalid (after the
+         *         subcommand's help was published).
+         */
+        int invoke(const int argc, char **argv) const {
+            const auto schema = make_schema_();
+            const auto views = parse_command_line_views(schema, argc, argv, publish_help_info_);
+            if (views.has_errors()) return EXIT_FAILURE;
+
+            if constexpr (std::is_void_v<decltype(run_(views))>) {
+                run_(views);
+                return EXIT_SUCCESS;
+            } else {
+                return static_cast<int>(run_(views));
+            }
+        }
+
+        void publish_help() const {
+            if (publish_help_info_) publish_help_info_();
+        }
+
+    private:
+        MakeSchema make_schema_;
+        Run run_;
+        std::function<void()> publish_help_info_;
+    };
+
+    /**
+     * \brief A subcommand that has subcommands of its own (e.g., 'tool remote add').
+     */
+    template<detail::fixed_name_ Name, typename Subcommands>
+    class subcommand_group_t final {
+    public:
+        static constexpr std::string_view name = Name.view();
+
+        subcommand_group_t(Subcommands subcommands, std::function<void()> publish_help_info)
+            : subcommands_(std::move(subcommands)), publish_help_info_(std::move(publish_help_info)) {}
+
+        int invoke(const int argc, char **argv) const { return subcommands_.dispatch(argc, argv, publish_help_info_); }
+
+        void publish_help() const {
+            if (publish_help_info_) publish_help_info_();
+        }
+
+    private:
+        Subcommands subcommands_;
+        std::function<void()> publish_help_info_;
+    };
+
+    /**
+     * \brief Declares a subcommand.
+     *
+     *        E.g.,
+     *        slx::subcommand<"commit">(
+     *            [] { return slx::make_command_line_schema({ {"message", "m", true}, {"all", "a", false} }); },
+     *            [](const auto &cmd_line) { return commit(cmd_line["message"]); },
+     *            commit_help)
+     *
+     *        'make_schema' returns the subcommand's command_line_schema; it is called only when
+     *        the subcommand is selected. 'run' is called with the subcommand's
+     *        command_line_views and returns its exit code (or void for EXIT_SUCCESS).
+     *        'publish_help_info' is called if one of its required options is missing or one of
+     *        its values is invalid.
+     */
+    template<detail::fixed_name_ Name, typename MakeSchema, typename Run>
+    subcommand_t<Name, MakeSchema, Run> subcommand(MakeSchema make_schema, Run run,
+                                                   std::function<void()> publish_help_info = {}) {
+        return {std::move(make_schema), std::move(run), std::move(publish_help_info)};
+    }
+
+    /**
+     * \brief Declares a subcommand that dispatches to the subcommands of 'subcommands'
+     *        (see make_command_line_subcommands); 'publish_help_info' is called if none of
+     *        them is named.
+     */
+    template<detail::fixed_name_ Name, typename Subcommands>
+    subcommand_group_t<Name, Subcommands> subcommand_group(Subcommands subcommands,
+                                                           std::function<void()> publish_help_info = {}) {
+        return {std::move(subcommands), std::move(publish_help_info)};
+    }
+
+    /**
+     * \brief A git style command line: argv[1] selects a subcommand, which parses the rest of
+     *        the command line with its own schema.
+     *
+     *        E.g.,
+     *        const auto commands = slx::make_command_line_subcommands(
+     *            slx::subcommand<"add">(make_add_schema, run_add, add_help),
+     *            slx::subcommand<"commit">(make_commit_schema, run_commit, commit_help));
+     *
+     *        return commands.dispatch(argc, argv, help_info);
+     *
+     *        The subcommand is found with a trie of the names that is built at compile time, so
+     *        a lookup costs one edge per character. Only the selected subcommand's schema is
+     *        built and matched against the remaining tokens; the others are never touched.
+     */
+    template<typename... Subcommands>
+    class command_line_subcommands final {
+        static_assert(sizeof...(Subcommands) > 0, "At least one subcommand is required.");
+
+        static constexpr std::size_t trie_capacity = 1 + (Subcommands::name.size() + ...);
+
+        static constexpr detail::subcommand_trie_<trie_capacity> make_trie_() {
+            detail::subcommand_trie_<trie_capacity> trie;
+            std::size_t command = 0;
+            (trie.insert(Subcommands::name, command++), ...);
+            return trie;
+        }
+
+        static constexpr auto trie_ = make_trie_();
+
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        static constexpr std::size_t size = sizeof...(Subcommands);
+
+        explicit command_line_subcommands(Subcommands... subcommands)
+            : subcommands_(std::move(subcommands)...) {}
+
+        /**
+         * \brief The index of the subcommand named 'name', or npos.
+         */
+        [[nodiscard]] static constexpr std::size_t find(const std::string_view name) noexcept { return trie_.find(name); }
+
+        /**
+         * \brief Runs the subcommand named by argv[1] with the arguments that follow it.
+         * @return The subcommand's exit code, or EXIT_FAILURE (after calling publish_help_info)
+         *         if argv[1] is missing or is not a subcommand.
+         */
+        int dispatch(const int argc, char **argv, const std::function<void()> &publish_help_info) const {
+            const auto index = argc > 1 && argv[1] ? find(argv[1]) : npos;
+            if (npos == index) {
+                if (publish_help_info) publish_help_info();
+                return EXIT_FAILURE;
+            }
+            return visit_(index, [&](const auto &command) { return command.invoke(argc - 1, argv + 1); },
+                          std::index_sequence_for<Subcommands...>{});
+        }
+
+        /**
+         * \brief Publishes the help of the subcommand named 'name' (e.g., for 'tool help commit').
+         * @return false if there is no such subcommand.
+         */
+        bool publish_help(const std::string_view name) const {
+            const auto index = find(name);
+            if (npos == index) return false;
+            visit_(index, [](const auto &command) { return command.publish_help(), 0; },
+                   std::index_sequence_for<Subcommands...>{});
+            return true;
+        }
+
+    private:
+        template<typename Visitor, std::size_t... I>
+        int visit_(const std::size_t index, Visitor &&visitor, std::index_sequence<I...>) const {
+            auto result = EXIT_FAILURE;
+            static_cast<void>(((I == index ? (result = visitor(std::get<I>(subcommands_)), true) : false) || ...));
+            return result;
+        }
+
+        std::tuple<Subcommands...> subcommands_;
+    };
+
+    template<typename... Subcommands>
+    command_line_subcommands<Subcommands...> make_command_line_subcommands(Subcommands... subcommands) {
+        return command_line_subcommands<Subcommands...>(std::move(subcommands)...);
+    }
+}
+
+#endif // CMD_LINE_SUBCOMMANDS_HH__
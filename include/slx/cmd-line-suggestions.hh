@@ -0,0 +1,192 @@
+#pragma once
+#ifndef CMD_LINE_SUGGESTIONS_HH__
+#define CMD_LINE_SUGGESTIONS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+// Opt-in: including this header in any translation unit of the program enables
+// parse_mode::strict, whose unknown options carry suggestions (see parse_mode).
+//
+#include "cmd-line-schema.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace slx {
+    namespace detail {
+        /**
+         * \brief The Levenshtein distance from one pattern to many texts, computed a column at a
+         *        time with Myers' bit-parallel algorithm (in Hyyrö's formulation): the pattern's
+         *        character masks are built once and each text costs a few word operations per
+         *        character. Patterns longer than 64 characters use the quadratic algorithm.
+         */
+        class edit_distance_kernel_ final {
+        public:
+            explicit edit_distance_kernel_(const std::string_view pattern) noexcept : pattern_(pattern) {
+                if (pattern_.size() > 64) return;
+                for (std::size_t i = 0; i < pattern_.size(); ++i) {
+                    peq_[static_cast<unsigned char>(pattern_[i])] |= std::uint64_t{1} << i;
+                }
+            }
+
+            [[nodiscard]] std::size_t distance(const std::string_view text) const {
+                const auto m = pattern_.size();
+                if (0 == m) return text.size();
+                if (m > 64) return quadratic_distance_(text);
+
+                const auto last = std::uint64_t{1} << (m - 1);
+                std::uint64_t pv = ~std::uint64_t{0};
+                std::uint64_t mv = 0;
+                auto score = m;
+                for (const auto c: text) {
+                    const auto eq = peq_[static_cast<unsigned char>(c)];
+                    const auto xv = eq | mv;
+                    const auto xh = (((eq & pv) + pv) ^ pv) | eq;
+                    auto ph = mv | ~(xh | pv);
+                    auto mh = pv & xh;
+                    if (ph & last) ++score;
+                    else if (mh & last) --score;
+                    // The first row of the matrix grows by one per text character.
+                    ph = (ph << 1) | 1;
+                    mh <<= 1;
+                    pv = mh | ~(xv | ph);
+                    mv = ph & xv;
+                }
+                return score;
+            }
+
+        private:
+            [[nodiscard]] std::size_t quadratic_distance_(const std::string_view text) const {
+                // Indexed by the pattern's length rather than row.back(), which the optimizer
+                // cannot prove is called on a non-empty row.
+                const auto m = pattern_.size();
+                std::vector<std::size_t> row(m + 1);
+                for (std::size_t i = 0; i <= m; ++i) row[i] = i;
+                for (std::size_t j = 1; j <= text.size(); ++j) {
+                    auto diagonal = row[0];
+                    row[0] = j;
+                    for (std::size_t i = 1; i <= m; ++i) {
+                        const auto above = row[i];
+                        row[i] = std::min({row[i] + 1, row[i - 1] + 1,
+                                           diagonal + (pattern_[i - 1] == text[j - 1] ? 0u : 1u)});
+                        diagonal = above;
+                    }
+                }
+                return row[m];
+            }
+
+            std::string_view pattern_;
+            std::array<std::uint64_t, 256> peq_{};
+        };
+
+        /**
+         * \brief The set of characters in 'text', folded into 64 bits. One edit changes at most
+         *        two bits, so half the bits that differ between two signatures is a lower bound
+         *        of the edit distance that costs no loop carried dependency to compute.
+         */
+        inline std::uint64_t character_signature_(const std::string_view text) noexcept {
+            std::uint64_t signature = 0;
+            for (const auto c: text) signature |= std::uint64_t{1} << (static_cast<unsigned char>(c) & 63u);
+            return signature;
+        }
+
+        /**
+         * \brief The registered name closest to an unknown option token ('--thread' suggests
+         *        '--threads'), or an empty string if none is close enough.
+         *
+         *        The long and short names of 'options' (any table with size, long_name and
+         *        short_name) are candidates. A name is a match if it is at most a third of
+         *        the token's length away (up to 3 edits); of equally distant names, one that
+         *        shares the token's first character is preferred. Names whose length, first
+         *        character and character signature put them beyond the best match so far are
+         *        skipped without running the kernel, so the table is read in a single pass.
+         */
+        template<typename OptionTable>
+        std::string suggest_option_(const OptionTable &options, std::string_view token) {
+            const auto dashes = token.starts_with("--") ? 2u : token.starts_with('-') ? 1u : 0u;
+            token.remove_prefix(dashes);
+            const auto max_distance = std::min<std::size_t>(3, token.size() / 3);
+            if (0 == max_distance) return {};
+
+            const edit_distance_kernel_ kernel(token);
+            const auto token_signature = character_signature_(token);
+
+            // Candidates are ranked by twice their distance, plus one if the first character differs.
+            auto best = (max_distance + 1) * 2;
+            std::string_view suggestion;
+            auto is_short = false;
+
+            const auto consider = [&](const std::string_view name, const bool short_name) {
+                const std::size_t other_first = name.front() != token.front() ? 1 : 0;
+                const auto length_difference = name.size() > token.size() ? name.size() - token.size()
+                                                                          : token.size() - name.size();
+                if (std::max(length_difference, other_first) * 2 + other_first >= best) return;
+                const auto differing = static_cast<std::size_t>(std::popcount(character_signature_(name) ^ token_signature));
+                if ((differing + 1) / 2 * 2 + other_first >= best) return;
+
+                const auto rank = kernel.distance(name) * 2 + other_first;
+                if (rank >= best) return;
+                best = rank;
+                suggestion = name;
+                is_short = short_name;
+            };
+
+            for (std::size_t i = 0; i < options.size(); ++i) {
+                if (const std::string_view name = options.long_name(i); !name.empty()) consider(name, false);
+                if (const std::string_view name = options.short_name(i); !name.empty()) consider(name, true);
+            }
+            if (suggestion.empty()) return {};
+            return (is_short ? "-" : "--") + std::string(suggestion);
+        }
+
+        inline std::string suggest_option_names_(const option_names_ &options, const std::string_view token) {
+            return suggest_option_(options, token);
+        }
+
+        inline const bool suggestions_installed_ = [] {
+            parse_extensions_instance_().suggest_option.store(&suggest_option_names_, std::memory_order_release);
+            return true;
+        }();
+    }
+
+    /**
+     * \brief The registered option closest to an unknown token (e.g., '--thread' gives
+     *        '--threads'), or an empty string if none is within a few edits.
+     */
+    [[nodiscard]] inline std::string suggest_command_line_option(const command_line_options_t &options,
+                                                                 const std::string_view token) {
+        return detail::suggest_option_(detail::runtime_option_table_{options}, token);
+    }
+
+    /**
+     * \brief The schema option closest to an unknown token (e.g., '--thread' gives '--threads'),
+     *        or an empty string if none is within a few edits.
+     */
+    template<std::size_t N>
+    [[nodiscard]] std::string suggest_command_line_option(const command_line_schema<N> &options,
+                                                          const std::string_view token) {
+        return detail::suggest_option_(options, token);
+    }
+}
+
+#endif // CMD_LINE_SUGGESTIONS_HH__
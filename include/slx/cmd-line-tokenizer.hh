@@ -0,0 +1,287 @@
+#pragma once
+#ifndef CMD_LINE_TOKENIZER_HH__
+#define CMD_LINE_TOKENIZER_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Define SLX_CMD_LINE_NO_SIMD to use the scalar tokenizer only. AVX2 is used when the
+// compiler targets it (e.g., -mavx2 or -march=native); SSE2 is part of every x86-64 target.
+//
+#if !defined(SLX_CMD_LINE_NO_SIMD)
+#   if defined(__AVX2__)
+#       define SLX_CMD_LINE_AVX2 1
+#   endif
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define SLX_CMD_LINE_SSE2 1
+#       include <immintrin.h>
+#   endif
+#endif
+
+namespace slx {
+    namespace detail {
+        enum char_class_ : unsigned char { plain_ = 0, space_ = 1, quote_ = 2, escape_ = 3 };
+
+        constexpr std::array<unsigned char, 256> make_char_classes_() noexcept {
+            std::array<unsigned char, 256> classes{};
+            for (const auto c: {' ', '\t', '\n', '\r', '\v', '\f'}) classes[static_cast<unsigned char>(c)] = space_;
+            classes[static_cast<unsigned char>('"')] = quote_;
+            classes[static_cast<unsigned char>('\'')] = quote_;
+            classes[static_cast<unsigned char>('\\')] = escape_;
+            return classes;
+        }
+
+        inline constexpr auto char_classes_ = make_char_classes_();
+
+        constexpr bool is_space_(const char c) noexcept {
+            return space_ == char_classes_[static_cast<unsigned char>(c)];
+        }
+
+        /**
+         * \brief The first byte of [p, end) that is whitespace, a quote or a backslash.
+         */
+        inline char *find_unquoted_boundary_(char *p, char *const end) noexcept {
+#if defined(SLX_CMD_LINE_AVX2)
+            {
+                const auto space = _mm256_set1_epi8(' ');
+                const auto double_quote = _mm256_set1_epi8('"');
+                const auto single_quote = _mm256_set1_epi8('\'');
+                const auto backslash = _mm256_set1_epi8('\\');
+                const auto tab = _mm256_set1_epi8('\t');
+                const auto four = _mm256_set1_epi8(4);
+                for (; end - p >= 32; p += 32) {
+                    const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                    // '\t' through '\r' are the bytes whose distance from '\t' is at most four.
+                    const auto control = _mm256_sub_epi8(c, tab);
+                    const auto found = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(c, space), _mm256_cmpeq_epi8(c, double_quote)),
+                        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, single_quote), _mm256_cmpeq_epi8(c, backslash)),
+                                        _mm256_cmpeq_epi8(_mm256_min_epu8(control, four), control)));
+                    const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(found));
+                    if (mask) return p + std::countr_zero(mask);
+                }
+            }
+#endif
+#if defined(SLX_CMD_LINE_SSE2)
+            {
+                const auto space = _mm_set1_epi8(' ');
+                const auto double_quote = _mm_set1_epi8('"');
+                const auto single_quote = _mm_set1_epi8('\'');
+                const auto backslash = _mm_set1_epi8('\\');
+                const auto tab = _mm_set1_epi8('\t');
+                const auto four = _mm_set1_epi8(4);
+                for (; end - p >= 16; p += 16) {
+                    const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    const auto control = _mm_sub_epi8(c, tab);
+                    const auto found = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, double_quote)),
+                        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, single_quote), _mm_cmpeq_epi8(c, backslash)),
+                                     _mm_cmpeq_epi8(_mm_min_epu8(control, four), control)));
+                    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+                    if (mask) return p + std::countr_zero(mask);
+                }
+            }
+#endif
+            while (p < end && plain_ == char_classes_[static_cast<unsigned char>(*p)]) ++p;
+            return p;
+        }
+
+        /**
+         * \brief The first '"' or '\' of [p, end) (the bytes that end a run inside double quotes).
+         */
+        inline char *find_double_quoted_boundary_(char *p, char *const end) noexcept {
+#if defined(SLX_CMD_LINE_AVX2)
+            {
+                const auto double_quote = _mm256_set1_epi8('"');
+                const auto backslash = _mm256_set1_epi8('\\');
+                for (; end - p >= 32; p += 32) {
+                    const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                    const auto found = _mm256_or_si256(_mm256_cmpeq_epi8(c, double_quote), _mm256_cmpeq_epi8(c, backslash));
+                    const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(found));
+                    if (mask) return p + std::countr_zero(mask);
+                }
+            }
+#endif
+#if defined(SLX_CMD_LINE_SSE2)
+            {
+                const auto double_quote = _mm_set1_epi8('"');
+                const auto backslash = _mm_set1_epi8('\\');
+                for (; end - p >= 16; p += 16) {
+                    const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    const auto found = _mm_or_si128(_mm_cmpeq_epi8(c, double_quote), _mm_cmpeq_epi8(c, backslash));
+                    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+                    if (mask) return p + std::countr_zero(mask);
+                }
+            }
+#endif
+            while (p < end && '"' != *p && '\\' != *p) ++p;
+            return p;
+        }
+
+        inline char *find_single_quoted_boundary_(char *p, char *const end) noexcept {
+            const auto found = static_cast<char *>(std::memchr(p, '\'', static_cast<std::size_t>(end - p)));
+            return found ? found : end;
+        }
+
+        /**
+         * \brief Splits [p, end) into shell style tokens in a single pass, calling emit(view) for
+         *        each token. Quotes and escapes are removed in place, so every token is a view into
+         *        the buffer; bytes are only moved once a token has had something removed. Runs of
+         *        ordinary bytes are found 16 or 32 bytes at a time (SSE2/AVX2).
+         *
+         *        - Tokens are separated by whitespace.
+         *        - '...' is literal.
+         *        - "..." is literal except that \" and \\ are escapes.
+         *        - Outside of quotes a backslash escapes the next character.
+         *        - A token that is entirely one "..." keeps its outer quotes, so that the parser
+         *          treats it as a value even if it begins with '-' and strips the quotes itself
+         *          (e.g., --pattern "-x y"), as it does for argv.
+         */
+        template<typename Emit>
+        void tokenize_in_place_(char *p, char *const end, Emit &&emit) {
+            enum class state_ : unsigned char { unquoted, double_quoted, single_quoted };
+
+            while (p < end) {
+                while (p < end && is_space_(*p)) ++p;
+                if (p == end) break;
+
+                char *const start = p;
+                char *content = p;
+                auto state = state_::unquoted;
+                auto leading_quote = false;
+                if ('"' == *p) {
+                    state = state_::double_quoted;
+                    leading_quote = true;
+                    content = ++p;
+                }
+                char *w = p;
+
+                while (p < end) {
+                    char *const run_end = state_::unquoted == state        ? find_unquoted_boundary_(p, end)
+                                          : state_::double_quoted == state ? find_double_quoted_boundary_(p, end)
+                                                                           : find_single_quoted_boundary_(p, end);
+                    if (w != p) std::memmove(w, p, static_cast<std::size_t>(run_end - p));
+                    w += run_end - p;
+                    p = run_end;
+                    if (p == end) break;
+
+                    const auto c = *p;
+                    if (state_::single_quoted == state) {
+                        state = state_::unquoted;
+                        ++p;
+                    } else if (state_::double_quoted == state) {
+                        if ('"' == c) {
+                            state = state_::unquoted;
+                            ++p;
+                            if (leading_quote && (p == end || is_space_(*p))) {
+                                // The whole token was one "...": restore its quotes (the
+                                // opening quote was never overwritten).
+                                *w++ = '"';
+                                content = start;
+                                break;
+                            }
+                            leading_quote = false;
+                            continue;
+                        }
+                        if (p + 1 < end && ('"' == p[1] || '\\' == p[1])) ++p;
+                        *w++ = *p++;
+                    } else if (is_space_(c)) {
+                        break;
+                    } else if ('"' == c) {
+                        state = state_::double_quoted;
+                        ++p;
+                    } else if ('\'' == c) {
+                        state = state_::single_quoted;
+                        ++p;
+                    } else {
+                        if (p + 1 < end) ++p;
+                        *w++ = *p++;
+                    }
+                }
+
+                emit(std::string_view(content, static_cast<std::size_t>(w - content)));
+                if (p < end) ++p;
+            }
+        }
+    }
+
+    /**
+     * \brief Splits a flat command line (e.g., "tool --in \"my file.json\" -j 8") into tokens
+     *        that can be passed to the parser in place of argc/argv.
+     *
+     *        E.g.,
+     *        slx::command_line_tokens tokens(line);
+     *        slx::parser_context context;
+     *        slx::parse_command_line_args(context, options, tokens, help_info);
+     *
+     *        The first token is the application, as argv[0] is. Quoting and escaping follow
+     *        the rules of tokenize_in_place_; the tokens are views into the tokenized buffer,
+     *        which is either a copy owned by this object or, with tokenize, the caller's
+     *        buffer (unescaped in place). Tokens are therefore neither copyable nor movable.
+     */
+    class command_line_tokens final {
+    public:
+        command_line_tokens() = default;
+
+        explicit command_line_tokens(const std::string_view command_line) { assign(command_line); }
+
+        command_line_tokens(const command_line_tokens &) = delete;
+        command_line_tokens &operator=(const command_line_tokens &) = delete;
+
+        /**
+         * \brief Tokenizes a copy of 'command_line'.
+         */
+        void assign(const std::string_view command_line) {
+            buffer_.assign(command_line);
+            tokenize(std::span<char>(buffer_.data(), buffer_.size()));
+        }
+
+        /**
+         * \brief Tokenizes 'buffer' in place; the tokens view it, so it must outlive them.
+         */
+        void tokenize(const std::span<char> buffer) {
+            tokens_.clear();
+            detail::tokenize_in_place_(buffer.data(), buffer.data() + buffer.size(),
+                                       [&](const std::string_view token) { tokens_.push_back(token); });
+        }
+
+        void clear() noexcept {
+            buffer_.clear();
+            tokens_.clear();
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return tokens_.size(); }
+        [[nodiscard]] bool empty() const noexcept { return tokens_.empty(); }
+        [[nodiscard]] std::string_view operator[](const std::size_t i) const noexcept { return tokens_[i]; }
+        [[nodiscard]] auto begin() const noexcept { return tokens_.begin(); }
+        [[nodiscard]] auto end() const noexcept { return tokens_.end(); }
+
+    private:
+        std::string buffer_;
+        std::vector<std::string_view> tokens_;
+    };
+}
+
+#endif // CMD_LINE_TOKENIZER_HH__
@@ -0,0 +1,264 @@
+#pragma once
+#ifndef CMD_LINE_VALUES_HH__
+#define CMD_LINE_VALUES_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-schema.hh"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace slx {
+    /**
+     * \brief The converted value of a typed option (see option_type).
+     *
+     *        Durations are stored as nanoseconds, byte sizes as bytes and enumerations as the
+     *        index of the choice.
+     */
+    union option_value_t {
+        std::int64_t integer;
+        std::uint64_t unsigned_integer;
+        double floating_point;
+        bool boolean;
+    };
+
+    namespace detail {
+        constexpr char to_lower_(const char c) noexcept {
+            return ('A' <= c && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        constexpr bool iequals_(const std::string_view a, const std::string_view b) noexcept {
+            if (a.size() != b.size()) return false;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (to_lower_(a[i]) != to_lower_(b[i])) return false;
+            }
+            return true;
+        }
+
+        inline bool to_int64_(std::string_view text, std::int64_t &out) noexcept {
+            if (!text.empty() && '+' == text.front()) text.remove_prefix(1);
+            auto base = 10;
+            if (text.size() > 2 && '0' == text[0] && ('x' == text[1] || 'X' == text[1])) {
+                text.remove_prefix(2);
+                base = 16;
+            }
+            if (text.empty()) return false;
+            const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out, base);
+            return std::errc{} == ec && end == text.data() + text.size();
+        }
+
+        inline bool to_double_(std::string_view text, double &out) noexcept {
+            if (!text.empty() && '+' == text.front()) text.remove_prefix(1);
+            if (text.empty()) return false;
+#if defined(__cpp_lib_to_chars)
+            const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+            return std::errc{} == ec && end == text.data() + text.size();
+#else
+            // std::from_chars for floating point is not available; strtod needs a terminated copy.
+            //
+            char buffer[64];
+            if (text.size() >= sizeof(buffer)) return false;
+            text.copy(buffer, text.size());
+            buffer[text.size()] = '\0';
+            char *end{};
+            out = std::strtod(buffer, &end);
+            return end == buffer + text.size();
+#endif
+        }
+
+        inline bool to_bool_(const std::string_view text, bool &out) noexcept {
+            if (text.empty() || iequals_(text, "true") || iequals_(text, "yes") || iequals_(text, "on") || "1" == text) {
+                out = true;
+                return true;
+            }
+            if (iequals_(text, "false") || iequals_(text, "no") || iequals_(text, "off") || "0" == text) {
+                out = false;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * \brief Splits "1.5ms" into "1.5" and "ms".
+         */
+        constexpr std::size_t number_length_(const std::string_view text) noexcept {
+            std::size_t i = 0;
+            if (i < text.size() && ('+' == text[i] || '-' == text[i])) ++i;
+            while (i < text.size() && (('0' <= text[i] && text[i] <= '9') || '.' == text[i])) ++i;
+            return i;
+        }
+
+        /**
+         * \brief number * scale; whole numbers are scaled exactly, fractions through a double.
+         */
+        template<typename Int>
+        bool to_scaled_(const std::string_view number, const Int scale, Int &out) noexcept {
+            std::int64_t whole{};
+            if (to_int64_(number, whole)) {
+                if (whole < 0 && std::is_unsigned_v<Int>) return false;
+                const auto limit = static_cast<std::uint64_t>(std::numeric_limits<Int>::max()) / static_cast<std::uint64_t>(scale);
+                const auto magnitude = whole < 0 ? 0 - static_cast<std::uint64_t>(whole) : static_cast<std::uint64_t>(whole);
+                if (magnitude > limit) return false;
+                out = static_cast<Int>(whole) * scale;
+                return true;
+            }
+
+            double fraction{};
+            if (!to_double_(number, fraction)) return false;
+            fraction *= static_cast<double>(scale);
+            if (!(std::fabs(fraction) < static_cast<double>(std::numeric_limits<Int>::max())) ||
+                (fraction < 0 && std::is_unsigned_v<Int>)) {
+                return false;
+            }
+            out = static_cast<Int>(fraction < 0 ? fraction - 0.5 : fraction + 0.5);
+            return true;
+        }
+
+        inline bool to_duration_ns_(const std::string_view text, std::int64_t &out) noexcept {
+            const auto n = number_length_(text);
+            const auto unit = text.substr(n);
+            std::int64_t scale{};
+            if (unit.empty() || iequals_(unit, "s")) scale = 1'000'000'000;
+            else if (iequals_(unit, "ms")) scale = 1'000'000;
+            else if (iequals_(unit, "us")) scale = 1'000;
+            else if (iequals_(unit, "ns")) scale = 1;
+            else if (iequals_(unit, "m") || iequals_(unit, "min")) scale = 60'000'000'000;
+            else if (iequals_(unit, "h")) scale = 3'600'000'000'000;
+            else if (iequals_(unit, "d")) scale = 86'400'000'000'000;
+            else return false;
+            return to_scaled_(text.substr(0, n), scale, out);
+        }
+
+        inline bool to_byte_size_(const std::string_view text, std::uint64_t &out) noexcept {
+            const auto n = number_length_(text);
+            auto unit = text.substr(n);
+            if (!unit.empty() && ('b' == unit.back() || 'B' == unit.back())) unit.remove_suffix(1);
+            if (!unit.empty() && ('i' == unit.back() || 'I' == unit.back())) unit.remove_suffix(1);
+
+            std::uint64_t scale{};
+            if (unit.empty()) scale = 1;
+            else if (iequals_(unit, "k")) scale = std::uint64_t{1} << 10;
+            else if (iequals_(unit, "m")) scale = std::uint64_t{1} << 20;
+            else if (iequals_(unit, "g")) scale = std::uint64_t{1} << 30;
+            else if (iequals_(unit, "t")) scale = std::uint64_t{1} << 40;
+            else return false;
+            return to_scaled_(text.substr(0, n), scale, out);
+        }
+
+        inline bool to_choice_(const std::string_view text, std::string_view choices, std::uint64_t &out) noexcept {
+            for (std::uint64_t index = 0;; ++index) {
+                const auto bar = choices.find('|');
+                if (choices.substr(0, bar) == text) {
+                    out = index;
+                    return true;
+                }
+                if (std::string_view::npos == bar) return false;
+                choices.remove_prefix(bar + 1);
+            }
+        }
+
+        /**
+         * \brief Converts a parsed value to its declared type.
+         * @return false if the value is not valid for the type.
+         */
+        inline bool convert_option_value_(const option_spec &option, const std::string_view text,
+                                          option_value_t &out) noexcept {
+            switch (option.type) {
+                case option_type::string: return true;
+                case option_type::integer: return to_int64_(text, out.integer);
+                case option_type::floating_point: return to_double_(text, out.floating_point);
+                case option_type::boolean: return to_bool_(text, out.boolean);
+                case option_type::duration: return to_duration_ns_(text, out.integer);
+                case option_type::byte_size: return to_byte_size_(text, out.unsigned_integer);
+                case option_type::enumeration: return to_choice_(text, option.choices, out.unsigned_integer);
+            }
+            return false;
+        }
+
+        template<typename T>
+        struct is_duration_ : std::false_type {};
+
+        template<typename Rep, typename Period>
+        struct is_duration_<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+        template<typename T>
+        constexpr bool dependent_false_ = false;
+
+        /**
+         * \brief True if the converted value is within the range of T (only integral and enum
+         *        types can be out of range), so that read_option_value_ does not truncate it.
+         */
+        template<typename T>
+        bool fits_option_value_(const option_type type, const option_value_t &value) noexcept {
+            if constexpr (std::is_enum_v<T>) {
+                return fits_option_value_<std::underlying_type_t<T>>(type, value);
+            } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+                switch (type) {
+                    case option_type::floating_point: {
+                        // The bounds are powers of two, so both are exact as doubles.
+                        const auto whole = std::trunc(value.floating_point);
+                        return whole >= static_cast<double>(std::numeric_limits<T>::min()) &&
+                               whole < static_cast<double>(std::numeric_limits<T>::max()) + 1.0;
+                    }
+                    case option_type::byte_size:
+                    case option_type::enumeration: return std::in_range<T>(value.unsigned_integer);
+                    default: return std::in_range<T>(value.integer);
+                }
+            } else {
+                return true;
+            }
+        }
+
+        /**
+         * \brief Reads a converted value as T; only casts, nothing is parsed. Check the range
+         *        with fits_option_value_ first.
+         */
+        template<typename T>
+        T read_option_value_(const option_type type, const option_value_t &value) noexcept {
+            if constexpr (std::is_same_v<T, bool>) {
+                return option_type::boolean == type ? value.boolean : 0 != value.integer;
+            } else if constexpr (is_duration_<T>::value) {
+                return std::chrono::duration_cast<T>(std::chrono::nanoseconds(value.integer));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                switch (type) {
+                    case option_type::floating_point: return static_cast<T>(value.floating_point);
+                    case option_type::byte_size:
+                    case option_type::enumeration: return static_cast<T>(value.unsigned_integer);
+                    default: return static_cast<T>(value.integer);
+                }
+            } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+                switch (type) {
+                    case option_type::floating_point: return static_cast<T>(value.floating_point);
+                    case option_type::byte_size:
+                    case option_type::enumeration: return static_cast<T>(value.unsigned_integer);
+                    default: return static_cast<T>(value.integer);
+                }
+            } else {
+                static_assert(dependent_false_<T>, "Unsupported option value type.");
+            }
+        }
+    }
+}
+
+#endif // CMD_LINE_VALUES_HH__
@@ -0,0 +1,313 @@
+#pragma once
+#ifndef CMD_LINE_VIEWS_HH__
+#define CMD_LINE_VIEWS_HH__
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------------------
+
+#include "cmd-line-values.hh"
+
+#include <memory>
+
+namespace slx {
+    /**
+     * \brief A parsed option. The key views the schema's long name and the value views argv.
+     */
+    struct command_line_view_t final {
+        std::string_view key{};
+        std::string_view value{};
+    };
+
+    /**
+     * \brief Why an option failed validation.
+     */
+    enum class option_error : std::uint8_t { missing_required, invalid_value };
+
+    /**
+     * \brief A validation error of the option at 'index' in the schema.
+     */
+    struct command_line_error_t final {
+        std::size_t index{};
+        option_error error{};
+    };
+
+    /**
+     * \brief A zero-copy alternative to command_line_options_result_t for a command_line_schema.
+     *
+     *        The parsed options are stored, in the order they were first seen, in a flat array
+     *        sized by the schema (plus one entry for "app"); nothing is copied out of argv and
+     *        nothing is allocated. Lookups hash the key through the schema.
+     *
+     *        The result views argv and the schema, so both must outlive it (argv lives for the
+     *        whole process and schemas are usually constexpr). Values read from response files
+     *        view the mappings of the parse, which the result (and every copy of it) shares.
+     */
+    template<std::size_t N>
+    class command_line_views final {
+    public:
+        using value_type = command_line_view_t;
+        using const_iterator = const command_line_view_t *;
+
+        /**
+         * \brief 'tokens' is shared with the result when the values view storage that the caller
+         *        does not keep (e.g., the command_line_expansion of a parse).
+         */
+        explicit command_line_views(const command_line_schema<N> &schema, std::shared_ptr<const void> tokens = {}) noexcept
+            : schema_(&schema), tokens_(std::move(tokens)) {}
+
+        [[nodiscard]] const command_line_schema<N> &schema() const noexcept { return *schema_; }
+
+        [[nodiscard]] const_iterator begin() const noexcept { return entries_.data(); }
+        [[nodiscard]] const_iterator end() const noexcept { return entries_.data() + size_; }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] bool empty() const noexcept { return 0 == size_; }
+
+        [[nodiscard]] std::size_t count(const std::string_view key) const noexcept { return find_(key) ? 1 : 0; }
+        [[nodiscard]] bool contains(const std::string_view key) const noexcept { return nullptr != find_(key); }
+
+        /**
+         * \brief The value of the option or an empty view when it is not present.
+         */
+        [[nodiscard]] std::string_view operator[](const std::string_view key) const noexcept {
+            const auto entry = find_(key);
+            return entry ? entry->value : std::string_view{};
+        }
+
+        /**
+         * \brief The converted value of a typed option (see option_type), or T{} if the option is
+         *        absent, its value was invalid or it does not fit in T (e.g., 300 for a
+         *        std::uint8_t). The value was converted during the parse, so this only compares
+         *        and casts.
+         *
+         *        E.g.,
+         *        auto threads = cmd_line.get<int>("threads");
+         *        auto timeout = cmd_line.get<std::chrono::milliseconds>("timeout");
+         *        std::string_view out = cmd_line.get<std::string_view>("out");
+         *
+         *        get<bool> of an option that is not a boolean reports its presence.
+         */
+        template<typename T>
+        [[nodiscard]] T get(const std::string_view key) const noexcept {
+            const auto index = schema_->find_long(key);
+            return command_line_schema<N>::npos != index ? get<T>(index) : T{};
+        }
+
+        template<typename T>
+        [[nodiscard]] T get(const std::string_view key, const T fallback) const noexcept {
+            const auto index = schema_->find_long(key);
+            return command_line_schema<N>::npos != index && readable_<T>(index) ? get<T>(index) : fallback;
+        }
+
+        template<typename T>
+        [[nodiscard]] T get(const std::size_t index) const noexcept {
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                return value(index);
+            } else {
+                if constexpr (std::is_same_v<T, bool>) {
+                    if (option_type::boolean != schema_->type(index)) return contains(index);
+                }
+                return readable_<T>(index) ? detail::read_option_value_<T>(schema_->type(index), typed_[index]) : T{};
+            }
+        }
+
+        /**
+         * \brief Records an invalid_value error for the option at 'index' if its value does not
+         *        fit in T (e.g., the field it is bound to), instead of letting it be truncated.
+         * @return false if the value was rejected.
+         */
+        template<typename T>
+        bool require_fits(const std::size_t index) noexcept {
+            if (!valid_[index] || detail::fits_option_value_<T>(schema_->type(index), typed_[index])) return true;
+            valid_[index] = false;
+            errors_[error_count_++] = {index, option_error::invalid_value};
+            return false;
+        }
+
+        /**
+         * \brief The validation errors of the last parse: every missing required option and every
+         *        value that could not be converted to its declared type.
+         */
+        [[nodiscard]] const command_line_error_t *errors_begin() const noexcept { return errors_.data(); }
+        [[nodiscard]] const command_line_error_t *errors_end() const noexcept { return errors_.data() + error_count_; }
+        [[nodiscard]] std::size_t error_count() const noexcept { return error_count_; }
+        [[nodiscard]] bool has_errors() const noexcept { return 0 != error_count_; }
+
+        /**
+         * \brief Converts the typed values and records the validation errors (one pass over the
+         *        schema; called by parse_command_line_views once the scan completes).
+         * @return true if there were no errors.
+         */
+        bool validate() noexcept {
+            error_count_ = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                typed_[i].unsigned_integer = 0;
+                valid_[i] = false;
+                if (!contains(i)) {
+                    if (schema_->is_required(i)) errors_[error_count_++] = {i, option_error::missing_required};
+                    continue;
+                }
+                valid_[i] = detail::convert_option_value_((*schema_)[i], value(i), typed_[i]);
+                if (!valid_[i]) errors_[error_count_++] = {i, option_error::invalid_value};
+            }
+            return 0 == error_count_;
+        }
+
+        /**
+         * \brief Presence and value by option index (the position of the option in the schema).
+         */
+        [[nodiscard]] bool contains(const std::size_t index) const noexcept { return 0 != positions_[index]; }
+        [[nodiscard]] bool is_valid(const std::size_t index) const noexcept { return valid_[index]; }
+        [[nodiscard]] std::string_view value(const std::size_t index) const noexcept {
+            return positions_[index] ? entries_[positions_[index] - 1].value : std::string_view{};
+        }
+
+        void clear() noexcept {
+            positions_ = {};
+            valid_ = {};
+            app_position_ = 0;
+            size_ = 0;
+            error_count_ = 0;
+        }
+
+        /**
+         * \brief Records the value of the option at 'index'; a repeated option keeps the last value.
+         */
+        void store(const std::size_t index, const std::string_view value) noexcept {
+            store_(positions_[index], schema_->long_name(index), value);
+        }
+
+        void store_app(const std::string_view value) noexcept { store_(app_position_, "app", value); }
+
+    private:
+        template<typename T>
+        [[nodiscard]] bool readable_(const std::size_t index) const noexcept {
+            return valid_[index] && detail::fits_option_value_<T>(schema_->type(index), typed_[index]);
+        }
+
+        void store_(std::size_t &position, const std::string_view key, const std::string_view value) noexcept {
+            if (0 == position) {
+                entries_[size_] = {key, value};
+                position = ++size_;
+                return;
+            }
+            entries_[position - 1].value = value;
+        }
+
+        [[nodiscard]] const command_line_view_t *find_(const std::string_view key) const noexcept {
+            const auto index = schema_->find_long(key);
+            const auto position = command_line_schema<N>::npos != index ? positions_[index]
+                                                                        : ("app" == key ? app_position_ : 0);
+            return position ? &entries_[position - 1] : nullptr;
+        }
+
+        const command_line_schema<N> *schema_;
+        std::shared_ptr<const void> tokens_;
+        std::array<command_line_view_t, N + 1> entries_{};
+        std::array<std::size_t, N> positions_{};
+        std::array<option_value_t, N> typed_{};
+        std::array<bool, N> valid_{};
+        std::array<command_line_error_t, N> errors_{};
+        std::size_t app_position_{};
+        std::size_t size_{};
+        std::size_t error_count_{};
+    };
+
+    /**
+     * \brief Check if the parsed views contain the option.
+     */
+    template<std::size_t N>
+    bool command_line_option(const command_line_views<N> &views, const std::string_view key) noexcept {
+        return views.contains(key);
+    }
+
+    /**
+     * \brief Get the value of an option from the parsed views (an empty view if absent).
+     */
+    template<std::size_t N>
+    std::string_view get_command_line_option(const command_line_views<N> &views, const std::string_view key) noexcept {
+        return views[key];
+    }
+
+    namespace detail {
+        template<bool include_app_path, std::size_t N, typename Tokens>
+        command_line_views<N> parse_command_line_views_(const command_line_schema<N> &options, const Tokens &tokens,
+                                                        const std::function<void()> &publish_help_info,
+                                                        std::shared_ptr<const void> owner = {}) {
+            [[maybe_unused]] const parse_timer_ timer;
+            command_line_views<N> result(options, std::move(owner));
+
+            if constexpr (include_app_path) {
+                if (tokens.size() > 0 && !tokens[0].empty()) result.store_app(tokens[0]);
+            }
+            scan_command_line_tokens_(tokens, [&](const std::string_view token) { return options.match(token); },
+                                      [&](const std::size_t index, const std::string_view value) {
+                                          result.store(index, value);
+                                      });
+
+            // Convert the typed values and check for missing required options in one pass; display
+            // help information if either fails.
+            //
+            if (!result.validate() && publish_help_info) publish_help_info();
+            return result;
+        }
+    }
+
+    /**
+     * \brief Same as parse_command_line_args for a command_line_schema, but the result views
+     *        argv and the schema and is returned instead of being copied into the global map.
+     *        Quotes are stripped by narrowing the view and typed values are converted once
+     *        (see command_line_views::get and command_line_views::errors_begin).
+     *
+     *        E.g.,
+     *        constexpr auto options = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+     *        const auto cmd_line = slx::parse_command_line_views(options, argc, argv, [](){});
+     *        std::string_view input_file = cmd_line["in"];
+     *
+     *        With parse_mode::response_files the values of options read from response files view
+     *        the mapped files, which stay open until the result and its copies are destroyed.
+     *        The result has no room for unknown or ambiguous options, so parse_mode::strict and
+     *        parse_mode::abbreviations are not supported.
+     * @throw std::invalid_argument if 'mode' has parse_mode::strict or parse_mode::abbreviations.
+     */
+    template<bool include_app_path = true, std::size_t N>
+    command_line_views<N> parse_command_line_views(const command_line_schema<N> &options, const int argc, char **argv,
+                                                   const std::function<void()> &publish_help_info,
+                                                   const parse_mode mode = parse_mode::none) {
+        if (const auto expand = detail::response_files_only_expansion_(mode, "parse_command_line_views")) {
+            // The views point into the response files, so the result shares the expansion.
+            //
+            auto expanded = expand(argc, argv);
+            return detail::parse_command_line_views_<include_app_path>(options, expanded.tokens, publish_help_info,
+                                                                       std::move(expanded.owner));
+        }
+        return detail::parse_command_line_views_<include_app_path>(options, detail::argv_tokens_(argc, argv),
+                                                                   publish_help_info);
+    }
+
+    /**
+     * \brief parse_command_line_views for a command line split by command_line_tokens; the
+     *        result views the tokens, which must outlive it.
+     */
+    template<bool include_app_path = true, std::size_t N>
+    command_line_views<N> parse_command_line_views(const command_line_schema<N> &options,
+                                                   const command_line_tokens &tokens,
+                                                   const std::function<void()> &publish_help_info) {
+        return detail::parse_command_line_views_<include_app_path>(options, tokens, publish_help_info);
+    }
+}
+
+#endif // CMD_LINE_VIEWS_HH__
@@ -0,0 +1,21 @@
+// A typical user of the library, as measured by measure-compile-time.cmake: a runtime
+// option table, a schema, and the lookups made by a typical main.
+//
+#include <slx/cmd-line-parsing.hh>
+#include <slx/cmd-line-schema.hh>
+#include <slx/cmd-line-views.hh>
+static constexpr auto g_schema = slx::make_command_line_schema({
+   {"in", "i", true},
+   {"threads", "j", false, slx::option_type::integer},
+   {"verbose", "v", false, slx::option_type::boolean} });
+
+int main(int argc, char* argv[])
+{
+   slx::command_line_options_t options{ {"out", "o", false} };
+   slx::parse_command_line_args(options, argc, argv, nullptr);
+
+   const auto cmd_line = slx::parse_command_line_views(g_schema, argc, argv, nullptr);
+   if (cmd_line.has_errors()) return 1;
+   const auto threads = cmd_line.get("threads", 1);
+   return slx::command_line_option("out") && threads > 0 ? 0 : 1;
+}
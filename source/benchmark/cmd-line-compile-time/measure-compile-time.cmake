@@ -0,0 +1,146 @@
+# ----------------------------------------------------------------------------------------
+# Copyright (c) William Berry
+# email: wberry.cpp@gmail.com
+# github: https://github.com/wsberry
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# You may freely use this source code and its projects in compliance with the License.
+#
+# You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License src distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# About:
+#	Measures the front-end cost of one translation unit using the library: the same source
+#	with the headers included and with the headers precompiled. Each is compiled with -fsyntax-only (no code generation) RUNS times and
+#	the median is reported, less that of an empty translation unit.
+#
+#	Run in script mode (see CMakeLists.txt):
+#	  cmake -DCXX=g++ -DCXX_ID=GNU -DCXX_STANDARD=20 -DINCLUDE_DIR=include
+#	        -DSOURCE_DIR=. -DWORK_DIR=build/compile-time [-DRUNS=5] -P measure-compile-time.cmake
+#
+#	The one-time cost of building the precompiled header is reported separately; it is paid
+#	once per target, not per translation unit.
+# -----------------------------------------------------------------------------------------
+
+foreach(variable CXX CXX_ID CXX_STANDARD INCLUDE_DIR SOURCE_DIR WORK_DIR)
+	IF (NOT DEFINED ${variable})
+		message(FATAL_ERROR "measure-compile-time: -D${variable}=... is required.")
+	ENDIF()
+endforeach()
+IF (NOT DEFINED RUNS)
+	SET(RUNS 5)
+ENDIF()
+
+IF (NOT CXX_ID MATCHES "^(GNU|Clang|AppleClang)$")
+	message(STATUS "measure-compile-time: ${CXX_ID} is not supported (GCC and Clang only).")
+	return()
+ENDIF()
+
+SET(std_flag "-std=c++${CXX_STANDARD}")
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/pch")
+file(WRITE "${WORK_DIR}/empty-tu.cpp" "int main() { return 0; }\n")
+
+# Runs a compiler command once, in 'directory'. Sets 'result_var' to the elapsed
+# milliseconds, or to an empty string if the command failed.
+#
+function(time_command directory result_var)
+	string(TIMESTAMP start "%s%f" UTC)
+	execute_process(COMMAND ${ARGN}
+					WORKING_DIRECTORY "${directory}"
+					RESULT_VARIABLE result
+					OUTPUT_QUIET ERROR_VARIABLE errors)
+	string(TIMESTAMP stop "%s%f" UTC)
+	IF (NOT result EQUAL 0)
+		string(LENGTH "${errors}" length)
+		IF (length GREATER 400)
+			string(SUBSTRING "${errors}" 0 400 errors)
+		ENDIF()
+		list(JOIN ARGN " " command)
+		message(STATUS "measure-compile-time: failed: ${command}\n${errors}")
+		SET(${result_var} "" PARENT_SCOPE)
+		return()
+	ENDIF()
+	math(EXPR elapsed "(${stop} - ${start}) / 1000")
+	SET(${result_var} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+# The median of RUNS runs of a compiler command, or an empty string if it failed.
+#
+function(median_command directory result_var)
+	SET(times)
+	foreach(run RANGE 1 ${RUNS})
+		time_command("${directory}" elapsed ${ARGN})
+		IF ("${elapsed}" STREQUAL "")
+			SET(${result_var} "" PARENT_SCOPE)
+			return()
+		ENDIF()
+		# Zero padded, so that the lexicographic sort is numeric.
+		string(LENGTH "${elapsed}" length)
+		math(EXPR padding "10 - ${length}")
+		string(REPEAT "0" ${padding} zeros)
+		list(APPEND times "${zeros}${elapsed}")
+	endforeach()
+	list(SORT times)
+	math(EXPR middle "${RUNS} / 2")
+	list(GET times ${middle} median)
+	string(REGEX REPLACE "^0+([0-9])" "\\1" median "${median}")
+	SET(${result_var} ${median} PARENT_SCOPE)
+endfunction()
+
+SET(header_tu "${SOURCE_DIR}/header-tu.cpp")
+SET(syntax_only ${CXX} ${std_flag} -fsyntax-only "-I${INCLUDE_DIR}")
+
+median_command("${WORK_DIR}" empty_ms ${CXX} ${std_flag} -fsyntax-only "${WORK_DIR}/empty-tu.cpp")
+median_command("${WORK_DIR}" header_ms ${syntax_only} "${header_tu}")
+
+# Precompiled header: the includes of header-tu.cpp.
+#
+file(WRITE "${WORK_DIR}/pch/cmd-line-pch.hh"
+	"#include <slx/cmd-line-parsing.hh>\n#include <slx/cmd-line-schema.hh>\n#include <slx/cmd-line-views.hh>\n")
+IF (CXX_ID STREQUAL "GNU")
+	SET(pch_file "${WORK_DIR}/pch/cmd-line-pch.hh.gch")
+	SET(use_pch -include "${WORK_DIR}/pch/cmd-line-pch.hh" -Winvalid-pch)
+ELSE()
+	SET(pch_file "${WORK_DIR}/pch/cmd-line-pch.hh.pch")
+	SET(use_pch -include-pch "${pch_file}")
+ENDIF()
+time_command("${WORK_DIR}/pch" pch_build_ms ${CXX} ${std_flag} "-I${INCLUDE_DIR}" -x c++-header
+			 "${WORK_DIR}/pch/cmd-line-pch.hh" -o "${pch_file}")
+IF (NOT "${pch_build_ms}" STREQUAL "")
+	median_command("${WORK_DIR}/pch" pch_ms ${syntax_only} ${use_pch} "${header_tu}")
+ENDIF()
+
+# Report.
+#
+function(report name total_ms)
+	IF ("${total_ms}" STREQUAL "")
+		message(STATUS "  ${name} unavailable (see the failure above)")
+		return()
+	ENDIF()
+	math(EXPR net "${total_ms} - ${empty_ms}")
+	IF (DEFINED header_net AND header_net GREATER 0)
+		math(EXPR percent "100 * ${net} / ${header_net}")
+		SET(relative ", ${percent}% of the headers")
+	ENDIF()
+	message(STATUS "  ${name} ${total_ms} ms (${net} ms over an empty translation unit${relative})")
+endfunction()
+
+message(STATUS "Front-end time of one translation unit (${CXX_ID} -fsyntax-only, median of ${RUNS}):")
+message(STATUS "  empty:            ${empty_ms} ms")
+report("headers:         " "${header_ms}")
+IF (NOT "${header_ms}" STREQUAL "")
+	math(EXPR header_net "${header_ms} - ${empty_ms}")
+ENDIF()
+report("precompiled:     " "${pch_ms}")
+IF ("${pch_build_ms}" STREQUAL "")
+	SET(pch_build_ms "unavailable")
+ELSE()
+	SET(pch_build_ms "${pch_build_ms} ms")
+ENDIF()
+message(STATUS "One-time cost: precompiled header ${pch_build_ms}")
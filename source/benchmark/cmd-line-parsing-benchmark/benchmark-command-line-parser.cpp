@@ -0,0 +1,550 @@
+#include "benchmark-command-line-parser.hh"
+
+// Benchmarks parse_command_line_args, the alternative results and their lookup accessors
+// across argc, schema size and value length.
+//
+// Usage:
+//    cpp-argv-parser-benchmark [--json results.json] [--baseline baseline.json] [--tolerance 10]
+//                              [--min-time 100ms] [--filter parse/args]
+//
+// Results are written as JSON (one benchmark object per line). With --baseline the results are
+// compared against a previous run and the exit code is EXIT_FAILURE if any benchmark is slower
+// than the baseline by more than --tolerance percent or allocates more per operation.
+
+// Counting Allocator Hook.
+//
+// Every heap allocation of the process goes through these replacements. A header in front of
+// each block records its size so that the live and peak byte counts can be kept.
+//
+namespace {
+   constexpr std::size_t allocation_header = alignof(std::max_align_t);
+
+   void* counted_allocate(const std::size_t size)
+   {
+      auto* block = static_cast<unsigned char*>(std::malloc(size + allocation_header));
+      if (!block) throw std::bad_alloc();
+      *reinterpret_cast<std::size_t*>(block) = size;
+
+      auto& heap = heap_counters();
+      heap.allocations.fetch_add(1, std::memory_order_relaxed);
+      const auto live = heap.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+      auto peak = heap.peak_bytes.load(std::memory_order_relaxed);
+      while (live > peak && !heap.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+      return block + allocation_header;
+   }
+
+   void counted_free(void* p) noexcept
+   {
+      if (!p) return;
+      auto* block = static_cast<unsigned char*>(p) - allocation_header;
+      heap_counters().live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+      std::free(block);
+   }
+}
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+
+// The options of the benchmark itself.
+//
+static constexpr auto g_benchmark_options = slx::make_command_line_schema({
+   {"json", "j", false},
+   {"baseline", "b", false},
+   {"tolerance", "t", false, slx::option_type::floating_point},
+   {"min-time", "m", false, slx::option_type::duration},
+   {"filter", "f", false},
+   {"help", "h", false, slx::option_type::boolean} });
+
+static std::vector<benchmark_result_t> g_results;
+static std::chrono::nanoseconds g_min_time{std::chrono::milliseconds(100)};
+static std::string_view g_filter{};
+
+// Keeps the optimizer from discarding a benchmarked operation.
+//
+static volatile std::size_t g_sink{};
+
+static auto display_help = []() {
+   std::cout
+      <<
+      "Usage: cpp-argv-parser-benchmark [options]"
+      "\n  --json,      -j: [optional] write the results to a file (default: stdout)"
+      "\n  --baseline,  -b: [optional] fail if slower than, or allocating more than, a previous run"
+      "\n  --tolerance, -t: [optional] allowed slowdown in percent (default: 10)"
+      "\n  --min-time,  -m: [optional] minimum time per benchmark (default: 100ms)"
+      "\n  --filter,    -f: [optional] only run benchmarks whose name contains the text\n"
+      << std::endl; /*flush*/
+};
+
+// Runs 'op' for at least g_min_time and records ns/op, allocations/op and the peak heap growth.
+//
+template<typename Operation>
+void run_benchmark(const std::string_view name, const std::size_t argc, const std::size_t options,
+                   const std::size_t value_length, Operation&& op)
+{
+   auto id = fmt::format("{}/argc:{}/options:{}/value:{}", name, argc, options, value_length);
+   if (!g_filter.empty() && std::string::npos == id.find(g_filter)) return;
+
+   auto& heap = heap_counters();
+   op(); // warm up
+
+   const auto live_before = heap.live_bytes.load();
+   heap.peak_bytes.store(live_before);
+   const auto allocations_before = heap.allocations.load();
+
+   using clock = std::chrono::steady_clock;
+   std::size_t iterations = 0;
+   std::size_t batch = 1;
+   const auto start = clock::now();
+   auto elapsed = clock::duration{};
+   do {
+      for (std::size_t i = 0; i < batch; ++i) op();
+      iterations += batch;
+      batch *= 2;
+      elapsed = clock::now() - start;
+   } while (elapsed < g_min_time);
+
+   benchmark_result_t result;
+   result.name = std::move(id);
+   result.argc = argc;
+   result.options = options;
+   result.value_length = value_length;
+   result.iterations = iterations;
+   result.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                      static_cast<double>(iterations);
+   result.allocations_per_op = static_cast<double>(heap.allocations.load() - allocations_before) /
+                               static_cast<double>(iterations);
+   result.peak_heap_bytes = heap.peak_bytes.load() - live_before;
+
+   std::cerr << fmt::format("{:<64} {:>14.1f} ns/op {:>10.1f} allocs/op {:>12} peak bytes\n", result.name,
+                            result.ns_per_op, result.allocations_per_op, result.peak_heap_bytes);
+   g_results.push_back(std::move(result));
+}
+
+// Benchmark Cases.
+//
+void benchmark_runtime_options(const std::size_t option_count, const std::size_t argc, const std::size_t value_length)
+{
+   const auto names = make_option_names(option_count);
+   slx::command_line_options_t options;
+   for (const auto& name : names) options.emplace_back(name, "", false);
+
+   auto cmd_line = make_command_line(names, argc, value_length);
+   slx::parser_context context;
+
+   run_benchmark("parse/args/runtime", argc, option_count, value_length, [&] {
+      g_sink = slx::parse_command_line_args(context, options, cmd_line.argc(), cmd_line.argv.data(), nullptr).size();
+   });
+
+   auto joined_cmd_line = make_command_line(names, argc, value_length, true);
+   run_benchmark("parse/args/runtime/joined", argc, option_count, value_length, [&] {
+      g_sink = slx::parse_command_line_args(context, options, joined_cmd_line.argc(), joined_cmd_line.argv.data(),
+                                            nullptr).size();
+   });
+
+   slx::command_line_options_result_t legacy_result;
+   run_benchmark("parse/args/runtime/legacy", argc, option_count, value_length, [&] {
+      g_sink = legacy_parse_command_line_args(legacy_result, options, cmd_line.argc(), cmd_line.argv.data()).size();
+   });
+
+   run_benchmark("parse/args/runtime/global", argc, option_count, value_length, [&] {
+      slx::clear_command_line_options();
+      g_sink = slx::parse_command_line_args(options, cmd_line.argc(), cmd_line.argv.data(), nullptr).size();
+   });
+
+   slx::command_line_lists lists;
+   run_benchmark("parse/lists/runtime", argc, option_count, value_length, [&] {
+      g_sink = slx::parse_command_line_lists(lists, options, cmd_line.argc(), cmd_line.argv.data(), nullptr).value_count();
+   });
+
+   std::vector<std::byte> storage(slx::command_line_lists::required_capacity(option_count, argc));
+   slx::command_line_lists fixed_lists(storage);
+   run_benchmark("parse/lists/runtime/fixed", argc, option_count, value_length, [&] {
+      g_sink = static_cast<std::size_t>(slx::try_parse_command_line_lists(fixed_lists, options, cmd_line.argc(),
+                                                                          cmd_line.argv.data()));
+   });
+
+   slx::parse_command_line_args(context, options, cmd_line.argc(), cmd_line.argv.data(), nullptr);
+   const auto& key = names.back();
+
+   run_benchmark("lookup/context/has_option", argc, option_count, value_length, [&] {
+      g_sink = context.has_option(key);
+   });
+
+   run_benchmark("lookup/context/option", argc, option_count, value_length, [&] {
+      g_sink = context.option(key).size();
+   });
+
+   run_benchmark("lookup/lists/values", argc, option_count, value_length, [&] {
+      g_sink = lists.values(key).size();
+   });
+
+   std::vector<std::byte> blob(slx::command_line_blob_size(context.args()));
+   run_benchmark("serialize/blob", argc, option_count, value_length, [&] {
+      g_sink = slx::write_command_line_blob(context.args(), blob);
+   });
+
+   const slx::command_line_blob blob_results(blob);
+   run_benchmark("lookup/blob/operator[]", argc, option_count, value_length, [&] {
+      g_sink = blob_results[key].size();
+   });
+}
+
+template<std::size_t N>
+void benchmark_schema(const std::size_t argc, const std::size_t value_length)
+{
+   const auto names = make_option_names(N);
+   auto specs = std::make_unique<std::array<slx::option_spec, N>>();
+   for (std::size_t i = 0; i < N; ++i) (*specs)[i] = {names[i], {}, false};
+   const auto schema = std::make_unique<const slx::command_line_schema<N>>(*specs);
+
+   auto cmd_line = make_command_line(names, argc, value_length);
+   slx::parser_context context;
+
+   run_benchmark("parse/args/schema", argc, N, value_length, [&] {
+      g_sink = slx::parse_command_line_args(context, *schema, cmd_line.argc(), cmd_line.argv.data(), nullptr).size();
+   });
+
+   run_benchmark("parse/views/schema", argc, N, value_length, [&] {
+      g_sink = slx::parse_command_line_views(*schema, cmd_line.argc(), cmd_line.argv.data(), nullptr).size();
+   });
+
+   slx::command_line_stream<N> session(*schema);
+   run_benchmark("parse/stream/schema", argc, N, value_length, [&] {
+      std::size_t events = 0;
+      const auto emit = [&](std::size_t, std::string_view) { ++events; };
+      for (int i = 1; i < cmd_line.argc(); ++i) session.feed(cmd_line.argv[static_cast<std::size_t>(i)], emit);
+      session.finish(emit);
+      g_sink = events;
+   });
+
+   const auto views = slx::parse_command_line_views(*schema, cmd_line.argc(), cmd_line.argv.data(), nullptr);
+   const std::string_view key = names.back();
+
+   run_benchmark("lookup/views/operator[]", argc, N, value_length, [&] {
+      g_sink = views[key].size();
+   });
+}
+
+// A strict parse of a command line without mistakes (the success path), and the suggestion
+// search for a misspelled option among 'option_count' names.
+//
+void benchmark_diagnostics(const std::size_t option_count, const std::size_t argc)
+{
+   const auto names = make_option_names(option_count);
+   slx::command_line_options_t options;
+   for (const auto& name : names) options.emplace_back(name, "", false);
+
+   auto cmd_line = make_command_line(names, argc, 16);
+   slx::parser_context context;
+
+   run_benchmark("parse/args/runtime/strict", argc, option_count, 16, [&] {
+      g_sink = slx::parse_command_line_args(context, options, cmd_line.argc(), cmd_line.argv.data(), nullptr,
+                                            slx::parse_mode::strict).size();
+   });
+
+   const auto misspelled = "--" + names.back().substr(0, names.back().size() - 1) + "x";
+   run_benchmark("diagnose/suggest/runtime", argc, option_count, 16, [&] {
+      g_sink = slx::suggest_command_line_option(options, misspelled).size();
+   });
+}
+
+// Building the completion index of 'option_count' feature flags and resolving a prefix in it.
+//
+void benchmark_completions(const std::size_t option_count)
+{
+   std::vector<std::string> names;
+   for (std::size_t i = 0; i < option_count; ++i) {
+      names.push_back(fmt::format("{}-feature-{}", 0 == i % 2 ? "enable" : "disable", i));
+   }
+   slx::command_line_options_t options;
+   for (const auto& name : names) options.emplace_back(name, "", false);
+
+   run_benchmark("index/completions/build", 1, option_count, 0, [&] {
+      g_sink = slx::command_line_completions(options).size();
+   });
+
+   const slx::command_line_completions completions(options);
+   const auto prefix = names[option_count / 2].substr(0, names[option_count / 2].size() - 1);
+   run_benchmark("lookup/completions/prefix", 1, option_count, 0, [&] {
+      const auto [first, last] = completions.prefix_range(prefix);
+      g_sink = last - first;
+   });
+}
+
+// Baseline Comparison.
+//
+static std::string_view json_field(const std::string_view line, const std::string_view field)
+{
+   const auto key = fmt::format("\"{}\": ", field);
+   const auto at = line.find(key);
+   if (std::string_view::npos == at) return {};
+   auto value = line.substr(at + key.size());
+   if (!value.empty() && '"' == value.front()) return value.substr(1, value.find('"', 1) - 1);
+   return value.substr(0, value.find_first_of(",}"));
+}
+
+static bool compare_with_baseline(const std::string& path, const double tolerance_percent)
+{
+   std::ifstream ifs(path);
+   if (!ifs) {
+      std::cerr << "Unable to read the baseline '" << path << "'.\n";
+      return false;
+   }
+
+   auto passed = true;
+   std::string line;
+   while (std::getline(ifs, line)) {
+      const auto name = json_field(line, "name");
+      if (name.empty()) continue;
+
+      const auto it = std::find_if(g_results.begin(), g_results.end(), [&](const auto& r) { return name == r.name; });
+      if (it == g_results.end()) continue;
+
+      const auto baseline_ns = std::strtod(std::string(json_field(line, "ns_per_op")).c_str(), nullptr);
+      const auto baseline_allocations = std::strtod(std::string(json_field(line, "allocations_per_op")).c_str(), nullptr);
+
+      if (it->ns_per_op > baseline_ns * (1.0 + tolerance_percent / 100.0)) {
+         std::cerr << fmt::format("REGRESSION {}: {:.1f} ns/op (baseline {:.1f})\n", name, it->ns_per_op, baseline_ns);
+         passed = false;
+      }
+      if (it->allocations_per_op > baseline_allocations + 0.5) {
+         std::cerr << fmt::format("REGRESSION {}: {:.1f} allocs/op (baseline {:.1f})\n", name,
+                                  it->allocations_per_op, baseline_allocations);
+         passed = false;
+      }
+   }
+   return passed;
+}
+
+static void write_results(std::ostream& os)
+{
+   os << "{\"benchmarks\": [\n";
+   for (std::size_t i = 0; i < g_results.size(); ++i) {
+      const auto& r = g_results[i];
+      os << fmt::format("{{\"name\": \"{}\", \"argc\": {}, \"options\": {}, \"value_length\": {}, \"iterations\": {}, "
+                        "\"ns_per_op\": {:.3f}, \"allocations_per_op\": {:.3f}, \"peak_heap_bytes\": {}}}{}\n",
+                        r.name, r.argc, r.options, r.value_length, r.iterations, r.ns_per_op,
+                        r.allocations_per_op, r.peak_heap_bytes, i + 1 < g_results.size() ? "," : "");
+   }
+   os << fmt::format("], \"peak_resident_bytes\": {}}}\n", peak_resident_bytes());
+}
+
+// Splits the command line, joined into one string with every other value quoted, and parses the tokens.
+//
+void benchmark_tokenizer(const std::size_t argc, const std::size_t value_length)
+{
+   const auto names = make_option_names(2);
+   slx::command_line_options_t options;
+   for (const auto& name : names) options.emplace_back(name, "", false);
+
+   const auto cmd_line = make_command_line(names, argc, value_length);
+   std::string line;
+   for (std::size_t i = 0; i < cmd_line.storage.size(); ++i) {
+      if (i) line += ' ';
+      if (i % 4 == 2) line += fmt::format("\"{}\"", cmd_line.storage[i]);
+      else line += cmd_line.storage[i];
+   }
+
+   slx::command_line_tokens tokens;
+   run_benchmark("tokenize/command_line", argc, 2, value_length, [&] {
+      tokens.assign(line);
+      g_sink = tokens.size();
+   });
+
+   slx::parser_context context;
+   run_benchmark("tokenize/command_line/parse", argc, 2, value_length, [&] {
+      tokens.assign(line);
+      g_sink = slx::parse_command_line_args(context, options, tokens, nullptr).size();
+   });
+}
+
+// Spawns a minimal binary that parses and dumps its command line, built with each output
+// backend (see startup/startup-probe.cpp), and measures the time from spawn to exit.
+//
+void benchmark_startup(const char* benchmark_path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+   const auto directory = std::filesystem::path(benchmark_path).parent_path();
+   const auto cmd_line = make_command_line(make_option_names(2), 3, 16);
+
+   for (const std::string_view backend : {"iostream", "write"}) {
+      const auto path = (directory / fmt::format("cpp-argv-parser-benchmark-startup-{}", backend)).string();
+      if (!std::filesystem::exists(path)) continue;
+      run_benchmark(fmt::format("startup/{}", backend), 3, 2, 16, [&] {
+         g_sink = spawn_and_wait(path, cmd_line);
+      });
+   }
+#else
+   static_cast<void>(benchmark_path);
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+   const auto cmd_line = slx::parse_command_line_views(g_benchmark_options, argc, argv, display_help);
+   if (cmd_line.has_errors()) return EXIT_FAILURE;
+   if (cmd_line.get<bool>("help")) {
+      display_help();
+      return EXIT_SUCCESS;
+   }
+
+   g_min_time = cmd_line.get("min-time", g_min_time);
+   g_filter = cmd_line["filter"];
+
+   // argc sweep (2 options, 16 byte values).
+   //
+   for (const std::size_t count : {1, 11, 101, 1'001, 10'001, 100'001}) {
+      benchmark_runtime_options(2, count, 16);
+      benchmark_schema<2>(count, 16);
+   }
+
+   // Schema size sweep (1k tokens, 16 byte values).
+   //
+   for (const std::size_t options : {50, 500, 5'000}) benchmark_runtime_options(options, 1'001, 16);
+   benchmark_schema<50>(1'001, 16);
+   benchmark_schema<500>(1'001, 16);
+   benchmark_schema<5'000>(1'001, 16);
+
+   // Value length sweep (2 options, 1k tokens).
+   //
+   for (const std::size_t length : {1, 256, 4'096}) {
+      benchmark_runtime_options(2, 1'001, length);
+      benchmark_schema<2>(1'001, length);
+   }
+
+   // Diagnostics for unknown options (1k tokens).
+   //
+   for (const std::size_t options : {50, 10'000}) benchmark_diagnostics(options, 1'001);
+
+   // Abbreviation and completion index.
+   //
+   for (const std::size_t options : {50, 10'000}) benchmark_completions(options);
+
+   // Command line string sweep (2 options, 1k tokens).
+   //
+   for (const std::size_t length : {1, 16, 256, 4'096}) benchmark_tokenizer(1'001, length);
+
+   // Process startup of a helper binary with each output backend.
+   //
+   benchmark_startup(argv[0]);
+
+   if (cmd_line.contains("json")) {
+      std::ofstream ofs{std::string(cmd_line["json"])};
+      write_results(ofs);
+   } else {
+      write_results(std::cout);
+   }
+
+   if (cmd_line.contains("baseline")) {
+      const auto tolerance = cmd_line.get("tolerance", 10.0);
+      return compare_with_baseline(std::string(cmd_line["baseline"]), tolerance) ? EXIT_SUCCESS : EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
+
+// Misc. Support Functions.
+//
+inline heap_counters_t& heap_counters()
+{
+   // Constant initialized, so it is usable by operator new before main.
+   //
+   static heap_counters_t counters;
+   return counters;
+}
+
+inline std::size_t peak_resident_bytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+   rusage usage{};
+   getrusage(RUSAGE_SELF, &usage);
+#   if defined(__APPLE__)
+   return static_cast<std::size_t>(usage.ru_maxrss);
+#   else
+   return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#   endif
+#else
+   return 0;
+#endif
+}
+
+inline std::vector<std::string> make_option_names(const std::size_t count)
+{
+   std::vector<std::string> names;
+   names.reserve(count);
+   for (std::size_t i = 0; i < count; ++i) names.push_back(fmt::format("option-{}", i));
+   return names;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+extern char** environ;
+
+// Runs 'path' with the arguments of 'cmd_line' and its output discarded.
+//
+inline bool spawn_and_wait(const std::string& path, const synthetic_command_line_t& cmd_line)
+{
+   std::vector<char*> argv(cmd_line.argv);
+   argv[0] = const_cast<char*>(path.c_str());
+   argv.push_back(nullptr);
+
+   posix_spawn_file_actions_t actions;
+   posix_spawn_file_actions_init(&actions);
+   posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+
+   pid_t pid{};
+   const auto spawned = 0 == posix_spawn(&pid, path.c_str(), &actions, nullptr, argv.data(), environ);
+   posix_spawn_file_actions_destroy(&actions);
+
+   int status{};
+   return spawned && pid == waitpid(pid, &status, 0) && WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status);
+}
+#endif
+
+// The lookup of the original parser, kept as the baseline that the indexed lookups are
+// measured against: every token is compared with every option through a linear find_if over
+// '--' + long name and '-' + short name, each comparison building temporary strings.
+//
+inline slx::command_line_options_result_t& legacy_parse_command_line_args(slx::command_line_options_result_t& result,
+                                                                          const slx::command_line_options_t& options,
+                                                                          const int argc, char** argv)
+{
+   result.clear();
+   std::string option;
+   for (auto i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (std::find_if(options.begin(), options.end(), [&](const auto& p) {
+             if (("--" + std::get<0>(p)) == arg || ("-" + std::get<1>(p)) == arg) {
+                option = std::get<0>(p);
+                return true;
+             }
+             return false;
+          }) == options.end()) {
+         continue;
+      }
+      if (i + 1 < argc && '-' != argv[i + 1][0]) result[option] = argv[++i];
+      else result[option] = "";
+   }
+   return result;
+}
+
+// argv[0] is the application; the rest alternate between an option (cycling through 'names')
+// and a value of 'value_length' characters. If 'joined' each option and its value are one
+// '--name=value' token.
+//
+inline synthetic_command_line_t make_command_line(const std::vector<std::string>& names, const std::size_t argc,
+                                                  const std::size_t value_length, const bool joined)
+{
+   synthetic_command_line_t cmd_line;
+   cmd_line.storage.reserve(argc);
+   cmd_line.storage.emplace_back("cpp-argv-parser-benchmark");
+   for (std::size_t i = 1; i < argc; ++i) {
+      if (1 == i % 2) cmd_line.storage.push_back("--" + names[(i / 2) % names.size()]);
+      else if (joined) cmd_line.storage.back().append("=").append(value_length, 'v');
+      else cmd_line.storage.emplace_back(value_length, 'v');
+   }
+   for (auto& token : cmd_line.storage) cmd_line.argv.push_back(token.data());
+   return cmd_line;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// About:
+//  Implements latency and allocation benchmarks for cpp-argv-parser
+// -----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <filesystem>
+#   include <fcntl.h>
+#   include <spawn.h>
+#   include <sys/resource.h>
+#   include <sys/wait.h>
+#endif
+
+#include <slx/cmd-line-parsing.hh>
+#include <slx/cmd-line-schema.hh>
+#include <slx/cmd-line-views.hh>
+#include <slx/cmd-line-lists.hh>
+#include <slx/cmd-line-tokenizer.hh>
+#include <slx/cmd-line-blob.hh>
+#include <slx/cmd-line-stream.hh>
+#include <slx/cmd-line-completions.hh>
+#include <slx/cmd-line-suggestions.hh>
+
+// Heap statistics kept by the replacement operator new/delete of the benchmark.
+//
+struct heap_counters_t final
+{
+   std::atomic<std::size_t> allocations{};
+   std::atomic<std::size_t> live_bytes{};
+   std::atomic<std::size_t> peak_bytes{};
+};
+
+// A data model for one benchmark case, written as one JSON object per line.
+//
+struct benchmark_result_t final
+{
+   std::string name{};
+   std::size_t argc{};
+   std::size_t options{};
+   std::size_t value_length{};
+   std::size_t iterations{};
+   double ns_per_op{};
+   double allocations_per_op{};
+   std::size_t peak_heap_bytes{}; // heap growth above what was live before the case
+};
+
+// A synthetic command line; 'argv' points into 'storage'.
+//
+struct synthetic_command_line_t final
+{
+   std::vector<std::string> storage{};
+   std::vector<char*> argv{};
+
+   [[nodiscard]] int argc() const { return static_cast<int>(argv.size()); }
+};
+
+// Misc. Helper Functions.
+//
+inline heap_counters_t& heap_counters();
+inline std::size_t peak_resident_bytes();
+inline std::vector<std::string> make_option_names(std::size_t count);
+#if defined(__unix__) || defined(__APPLE__)
+inline bool spawn_and_wait(const std::string& path, const synthetic_command_line_t& cmd_line);
+#endif
+inline slx::command_line_options_result_t& legacy_parse_command_line_args(slx::command_line_options_result_t& result,
+                                                                          const slx::command_line_options_t& options,
+                                                                          int argc, char** argv);
+inline synthetic_command_line_t make_command_line(const std::vector<std::string>& names, std::size_t argc,
+                                                  std::size_t value_length, bool joined = false);
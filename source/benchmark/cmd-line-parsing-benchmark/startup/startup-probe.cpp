@@ -0,0 +1,32 @@
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// About:
+//  A minimal helper binary that parses its command line and dumps the results. It is built
+//  twice, with and without SLX_CMD_LINE_NO_IOSTREAM, and spawned by the benchmark to measure
+//  process startup with each output backend.
+// -----------------------------------------------------------------------------------------
+
+#include <slx/cmd-line-parsing.hh>
+
+int main(int argc, char* argv[])
+{
+   slx::command_line_options_t options{ {"in", "i", false}, {"out", "o", false} };
+   slx::parse_command_line_args(options, argc, argv, nullptr);
+   slx::publish_command_line_args(argc, argv);
+   slx::publish_command_line_parse_results();
+   return EXIT_SUCCESS;
+}
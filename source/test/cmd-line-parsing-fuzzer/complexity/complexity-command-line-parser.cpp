@@ -0,0 +1,311 @@
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// About:
+//  Parses adversarial command lines at growing sizes and fails if the parse time or the number
+//  of allocations grows faster than linearly with the size of the input.
+//
+// Usage:
+//    cpp-argv-parser-complexity [--max-time-exponent 1.5] [--max-allocation-exponent 1.2]
+//                               [--filter shared-prefixes]
+//
+// For each shape the input size n doubles from 2^11 to 2^15. The growth exponent is
+// log(cost(n max) / cost(n min)) / log(n max / n min): 1 is linear and 2 quadratic. Times are
+// the fastest of several runs, so the exponent is stable on a busy machine.
+// -----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#include <slx/cmd-line-parsing.hh>
+#include <slx/cmd-line-schema.hh>
+#include <slx/cmd-line-views.hh>
+#include <slx/cmd-line-tokenizer.hh>
+#include <slx/cmd-line-suggestions.hh>
+#include <slx/cmd-line-completions.hh>
+
+// Counting Allocator Hook.
+//
+// Every form of new and delete goes through the same pair of functions, so GCC does not see
+// a pointer from operator new released with std::free (-Wmismatched-new-delete).
+//
+static std::atomic<std::size_t> g_allocations{};
+
+namespace {
+   void* counted_allocate(const std::size_t size)
+   {
+      g_allocations.fetch_add(1, std::memory_order_relaxed);
+      if (auto* p = std::malloc(size ? size : 1)) return p;
+      throw std::bad_alloc();
+   }
+
+   void counted_free(void* p) noexcept { std::free(p); }
+}
+
+void* operator new(const std::size_t size) { return counted_allocate(size); }
+void* operator new[](const std::size_t size) { return counted_allocate(size); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+
+static constexpr auto g_complexity_options = slx::make_command_line_schema({
+   {"max-time-exponent", "t", false, slx::option_type::floating_point},
+   {"max-allocation-exponent", "a", false, slx::option_type::floating_point},
+   {"filter", "f", false},
+   {"help", "h", false, slx::option_type::boolean} });
+
+static auto display_help = []() {
+   std::cout
+      <<
+      "Usage: cpp-argv-parser-complexity [options]"
+      "\n  --max-time-exponent,       -t: [optional] the largest growth exponent of the parse time (default: 1.5)"
+      "\n  --max-allocation-exponent, -a: [optional] the largest growth exponent of the allocations (default: 1.2)"
+      "\n  --filter,                  -f: [optional] only run shapes whose name contains the text\n"
+      << std::endl; /*flush*/
+};
+
+// Keeps the optimizer from discarding a parse.
+//
+static volatile std::size_t g_sink{};
+
+// An adversarial input of size n: an option table and a command line, as argv and as one
+// string. 'parse' runs the operation that is measured.
+//
+struct complexity_input_t final
+{
+   std::vector<std::string> names{};
+   slx::command_line_options_t options{};
+   std::vector<std::string> tokens{};
+   std::vector<char*> argv{};
+   std::string command_line{};
+   slx::parse_mode mode{slx::parse_mode::none};
+   std::function<void(complexity_input_t&)> parse{};
+
+   void add_option(std::string name, const std::string& short_name = {})
+   {
+      names.push_back(std::move(name));
+      names.push_back(short_name);
+   }
+
+   void add_token(std::string token)
+   {
+      if (!command_line.empty()) command_line += ' ';
+      command_line += token;
+      tokens.push_back(std::move(token));
+   }
+
+   // Called once the names and tokens are complete, as the views refer to them.
+   //
+   void finish()
+   {
+      for (std::size_t i = 0; i < names.size(); i += 2) options.emplace_back(names[i], names[i + 1], false);
+      for (auto& token : tokens) argv.push_back(token.data());
+      argv.push_back(nullptr);
+   }
+
+   [[nodiscard]] int argc() const { return static_cast<int>(tokens.size()); }
+};
+
+struct complexity_shape_t final
+{
+   std::string_view name;
+   std::function<void(complexity_input_t&, std::size_t)> make;
+};
+
+struct complexity_cost_t final
+{
+   double nanoseconds{};
+   double allocations{};
+};
+
+// Parses with a runtime option table (the common path of all shapes).
+//
+static void parse_args(complexity_input_t& input)
+{
+   slx::parser_context context;
+   g_sink = slx::parse_command_line_args(context, input.options, input.argc(), input.argv.data(), nullptr,
+                                         input.mode).size();
+}
+
+// Adversarial Shapes.
+//
+static const std::vector<complexity_shape_t> g_shapes{
+   // A huge argc over a small table.
+   {"huge-argc", [](complexity_input_t& input, const std::size_t n) {
+      for (auto i = 0; i < 8; ++i) input.add_option(fmt::format("option-{}", i));
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) input.add_token(fmt::format("--option-{}", i % 8)), input.add_token("value");
+      input.parse = parse_args;
+   }},
+   // A table whose names share a long prefix, every one of them given.
+   {"shared-prefixes", [](complexity_input_t& input, const std::size_t n) {
+      const std::string prefix(128, 'p');
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) {
+         input.add_option(fmt::format("{}-{}", prefix, i));
+         input.add_token(fmt::format("--{}-{}", prefix, i));
+      }
+      input.parse = parse_args;
+   }},
+   // Quoted values, from argv and from one command line string.
+   {"quoted-values", [](complexity_input_t& input, const std::size_t n) {
+      input.add_option("value", "v");
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) input.add_token("-v"), input.add_token(fmt::format("\"-a quoted value {}\"", i));
+      input.parse = [](complexity_input_t& in) {
+         parse_args(in);
+         const slx::command_line_tokens tokens(in.command_line);
+         slx::parser_context context;
+         g_sink = slx::parse_command_line_args(context, in.options, tokens, nullptr).size();
+      };
+   }},
+   // One key repeated, joined and bundled.
+   {"repeated-keys", [](complexity_input_t& input, const std::size_t n) {
+      input.add_option("key", "k");
+      input.add_option("flag", "f");
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) {
+         switch (i % 3) {
+            case 0: input.add_token("--key"), input.add_token("value"); break;
+            case 1: input.add_token("--key=value"); break;
+            default: input.add_token("-fkvalue"); break;
+         }
+      }
+      input.parse = parse_args;
+   }},
+   // Misspelled options, each one diagnosed with a suggestion.
+   {"unknown-options", [](complexity_input_t& input, const std::size_t n) {
+      for (auto i = 0; i < 64; ++i) input.add_option(fmt::format("enable-feature-{}", i));
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) input.add_token(fmt::format("--enable-featuer-{}", i % 64));
+      input.mode = slx::parse_mode::strict;
+      input.parse = parse_args;
+   }},
+   // Abbreviations of names that share a long prefix.
+   {"abbreviations", [](complexity_input_t& input, const std::size_t n) {
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) {
+         input.add_option(fmt::format("enable-feature-{:06}-for-the-parser", i));
+         input.add_token(fmt::format("--enable-feature-{:06}", i));
+      }
+      input.mode = slx::parse_mode::abbreviations;
+      input.parse = parse_args;
+   }},
+   // Prefixes of many names, each one reported with its candidates.
+   {"ambiguous", [](complexity_input_t& input, const std::size_t n) {
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) {
+         input.add_option(fmt::format("enable-feature-{:06}", i));
+         input.add_token("--enable-feature-0");
+      }
+      input.mode = slx::parse_mode::abbreviations;
+      input.parse = parse_args;
+   }},
+   // A global parse, then every option looked up.
+   {"lookups", [](complexity_input_t& input, const std::size_t n) {
+      input.add_token("complexity.app");
+      for (std::size_t i = 0; i < n; ++i) {
+         input.add_option(fmt::format("option-{}", i));
+         input.add_token(fmt::format("--option-{}", i));
+         input.add_token("value");
+      }
+      input.parse = [](complexity_input_t& in) {
+         g_sink = slx::parse_command_line_args(in.options, in.argc(), in.argv.data(), nullptr).size();
+         for (const auto& option : in.options) {
+            g_sink = g_sink + slx::get_command_line_option(std::get<0>(option)).size();
+            g_sink = g_sink + (slx::command_line_option(std::get<0>(option)) ? 1 : 0);
+         }
+         slx::clear_command_line_options();
+      };
+   }},
+};
+
+// The fastest of several runs and the allocations of one run.
+//
+static complexity_cost_t measure(complexity_input_t& input)
+{
+   using clock = std::chrono::steady_clock;
+   input.parse(input); // warm up
+
+   complexity_cost_t cost;
+   const auto allocations_before = g_allocations.load();
+   input.parse(input);
+   cost.allocations = static_cast<double>(g_allocations.load() - allocations_before);
+
+   auto fastest = clock::duration::max();
+   auto total = clock::duration{};
+   for (auto runs = 0; runs < 5 || (runs < 100 && total < std::chrono::milliseconds(20)); ++runs) {
+      const auto start = clock::now();
+      input.parse(input);
+      const auto elapsed = clock::now() - start;
+      fastest = std::min(fastest, elapsed);
+      total += elapsed;
+   }
+   cost.nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(fastest).count());
+   return cost;
+}
+
+int main(int argc, char* argv[])
+{
+   const auto cmd_line = slx::parse_command_line_views(g_complexity_options, argc, argv, display_help);
+   if (cmd_line.has_errors()) return EXIT_FAILURE;
+   if (cmd_line.get<bool>("help")) {
+      display_help();
+      return EXIT_SUCCESS;
+   }
+
+   const auto max_time_exponent = cmd_line.get("max-time-exponent", 1.5);
+   const auto max_allocation_exponent = cmd_line.get("max-allocation-exponent", 1.2);
+   const auto filter = cmd_line["filter"];
+
+   constexpr std::size_t smallest = std::size_t{1} << 11;
+   constexpr std::size_t largest = std::size_t{1} << 15;
+
+   auto failures = 0;
+   for (const auto& shape : g_shapes) {
+      if (!filter.empty() && std::string_view::npos == shape.name.find(filter)) continue;
+
+      std::vector<complexity_cost_t> costs;
+      for (auto n = smallest; n <= largest; n *= 2) {
+         complexity_input_t input;
+         shape.make(input, n);
+         input.finish();
+         costs.push_back(measure(input));
+         std::cout << fmt::format("{:<16} n:{:<6} {:>14.0f} ns {:>10.0f} allocations\n", shape.name, n,
+                                  costs.back().nanoseconds, costs.back().allocations);
+      }
+
+      const auto exponent = [&](const double first, const double last) {
+         return std::log(std::max(last, 1.0) / std::max(first, 1.0)) / std::log(double(largest) / double(smallest));
+      };
+      const auto time_exponent = exponent(costs.front().nanoseconds, costs.back().nanoseconds);
+      const auto allocation_exponent = exponent(costs.front().allocations, costs.back().allocations);
+      const auto passed = time_exponent <= max_time_exponent && allocation_exponent <= max_allocation_exponent;
+      if (!passed) ++failures;
+      std::cout << fmt::format("{:<16} time exponent: {:.2f}, allocation exponent: {:.2f} {}\n", shape.name,
+                               time_exponent, allocation_exponent, passed ? "ok" : "SUPER-LINEAR");
+   }
+   return 0 == failures ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,269 @@
+#include "fuzz-command-line-parser.hh"
+
+// A fuzz target for the parse functions, the alternative results and the validation of
+// untrusted images (completion indexes and serialized results).
+//
+// Built with Clang and -DSLX_LIBFUZZER=ON this is a libFuzzer target:
+//    cpp-argv-parser-fuzzer -max_total_time=600 corpus/
+//
+// Otherwise it is a standalone driver that runs the inputs of a corpus directory, or inputs
+// generated from a seed:
+//    cpp-argv-parser-fuzzer [--corpus corpus/] [--runs 10000] [--seed 1]
+//
+// Each input is checked for crashes, reads past argv (run it with AddressSanitizer) and
+// broken invariants of the results, which abort.
+
+// The schema of the schema based parse functions; it covers every option type and arity.
+//
+static constexpr auto g_fuzz_schema = slx::make_command_line_schema({
+   {"in", "i", false},
+   {"out", "o", false},
+   {"include", "I", false, {}, {}, slx::option_arity::repeated},
+   {"inputs", "", false, {}, {}, slx::option_arity::multiple},
+   {"threads", "j", false, slx::option_type::integer},
+   {"verbose", "v", false, slx::option_type::boolean},
+   {"mode", "m", false, slx::option_type::enumeration, "fast|safe"},
+   {"required", "r", true} });
+
+// The most values checked per result, so that one input cannot run for long.
+//
+static constexpr std::size_t g_max_checked = 64;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, const std::size_t size)
+{
+   auto input = decode_fuzz_input(data, size);
+   const auto [argv, argc] = make_fuzz_argv(input.tokens);
+
+   // The runtime option table, from argv and from the command line string.
+   //
+   slx::parser_context context;
+   const auto& results = slx::parse_command_line_args(context, input.options, argc, argv.get(), {}, input.mode);
+   const auto is_long_name = [&](const std::string_view key, const bool required) {
+      return std::any_of(input.options.begin(), input.options.end(), [&](const auto& option) {
+         return key == std::get<0>(option) && (!required || std::get<2>(option));
+      });
+   };
+   for (const auto& [key, value] : results) {
+      fuzz_check("app" == key || is_long_name(key, false), "a result is a registered option");
+   }
+   for (const auto& name : context.missing_options()) {
+      fuzz_check(is_long_name(name, true), "a missing option is a required option");
+   }
+
+   const auto blob = slx::make_command_line_blob(results);
+   const slx::command_line_blob serialized(blob);
+   fuzz_check(serialized.size() == results.size(), "a serialized result has every key");
+   for (std::size_t i = 0; i < serialized.size() && i < g_max_checked; ++i) {
+      const auto it = results.find(std::string(serialized.key(i)));
+      fuzz_check(it != results.end() && it->second == serialized.value(i), "a serialized result has every value");
+   }
+
+   const slx::command_line_tokens tokens(input.command_line);
+   slx::parse_command_line_args(context, input.options, tokens, {}, input.mode);
+
+   // The schema based results.
+   //
+   const auto views = slx::parse_command_line_views(g_fuzz_schema, argc, argv.get(), {});
+   fuzz_check(views.size() <= g_fuzz_schema.size(), "a view is a registered option");
+
+   slx::command_line_lists lists;
+   slx::parse_command_line_lists(lists, g_fuzz_schema, argc, argv.get(), {});
+   const auto max_values = slx::command_line_lists::max_value_count(argc, argv.get());
+   fuzz_check(lists.value_count() <= max_values, "every value is a token or a bundled flag");
+
+   static std::array<std::byte, slx::command_line_lists::required_capacity(g_fuzz_schema.size(), 64)> storage;
+   slx::command_line_lists fixed(storage);
+   const auto status = slx::try_parse_command_line_lists(fixed, g_fuzz_schema, argc, argv.get());
+   fuzz_check(max_values > 64 || slx::parse_status::out_of_capacity != status, "required_capacity is sufficient");
+
+   // A streamed command line ends with the same value per option as a full parse.
+   //
+   slx::command_line_stream session(g_fuzz_schema);
+   std::array<std::optional<std::string>, g_fuzz_schema.size()> streamed;
+   const auto emit = [&](const std::size_t option, const std::string_view value) { streamed[option] = value; };
+   for (std::size_t i = 1; i < input.tokens.size(); ++i) session.feed(input.tokens[i], emit);
+   session.finish(emit);
+   for (std::size_t i = 0; i < g_fuzz_schema.size(); ++i) {
+      fuzz_check(streamed[i].has_value() == lists.contains(i) && (!streamed[i] || *streamed[i] == lists.values(i).back()),
+                 "a streamed option has the value of a full parse");
+   }
+
+   // The completion index of the options.
+   //
+   const slx::command_line_completions completions(input.options);
+   for (std::size_t i = 1; i < input.tokens.size() && i < g_max_checked; ++i) {
+      std::string_view prefix = input.tokens[i];
+      while (prefix.starts_with('-')) prefix.remove_prefix(1);
+      const auto [first, last] = completions.prefix_range(prefix);
+      fuzz_check(first <= last && last <= completions.size(), "a prefix range is within the index");
+      for (auto j = first; j < last && j - first < g_max_checked; ++j) {
+         fuzz_check(completions.name(j).starts_with(prefix), "a prefix range holds only names with the prefix");
+      }
+      const auto option = completions.resolve(prefix);
+      fuzz_check(slx::command_line_completions::npos == option || option < input.options.size(),
+                 "a resolved abbreviation is an option");
+   }
+
+   // Untrusted images are validated before use.
+   //
+   const std::string_view image(reinterpret_cast<const char*>(data), size);
+   const slx::command_line_completions untrusted_completions(image);
+   for (std::size_t i = 0; i < untrusted_completions.size() && i < g_max_checked; ++i) {
+      fuzz_check(untrusted_completions.name(i).data() + untrusted_completions.name(i).size() <= image.data() + size,
+                 "a completion name is within the image");
+   }
+   const slx::command_line_blob untrusted_blob(image);
+   for (std::size_t i = 0; i < untrusted_blob.size() && i < g_max_checked; ++i) {
+      fuzz_check(untrusted_blob.value(i).data() + untrusted_blob.value(i).size() <= image.data() + size,
+                 "a blob value is within the image");
+   }
+   return 0;
+}
+
+#if !defined(SLX_LIBFUZZER)
+static constexpr auto g_driver_options = slx::make_command_line_schema({
+   {"corpus", "c", false},
+   {"runs", "n", false, slx::option_type::integer},
+   {"seed", "s", false, slx::option_type::integer},
+   {"help", "h", false, slx::option_type::boolean} });
+
+static auto display_help = []() {
+   std::fputs(
+      "Usage: cpp-argv-parser-fuzzer [options]"
+      "\n  --corpus, -c: [optional] run every file of a directory"
+      "\n  --runs,   -n: [optional] the number of generated inputs (default: 10000)"
+      "\n  --seed,   -s: [optional] the seed of the generated inputs (default: 1)\n",
+      stdout);
+};
+
+int main(int argc, char* argv[])
+{
+   const auto cmd_line = slx::parse_command_line_views(g_driver_options, argc, argv, display_help);
+   if (cmd_line.has_errors()) return EXIT_FAILURE;
+   if (cmd_line.get<bool>("help")) {
+      display_help();
+      return EXIT_SUCCESS;
+   }
+
+   std::size_t runs = 0;
+   if (cmd_line.contains("corpus")) {
+      for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(cmd_line["corpus"]))) {
+         if (!entry.is_regular_file()) continue;
+         const slx::mapped_file file(entry.path().string());
+         LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(file.data()), file.size());
+         ++runs;
+      }
+   } else {
+      auto state = static_cast<std::uint64_t>(cmd_line.get<std::int64_t>("seed", 1));
+      if (0 == state) state = 1; // a xorshift generator never leaves zero
+      const auto count = cmd_line.get<std::int64_t>("runs", 10'000);
+      for (; static_cast<std::int64_t>(runs) < count; ++runs) {
+         const auto bytes = generate_fuzz_input(state);
+         LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size());
+      }
+   }
+   std::printf("%zu inputs passed\n", runs);
+   return EXIT_SUCCESS;
+}
+#endif
+
+// Misc. Helper Functions.
+//
+inline fuzz_input_t decode_fuzz_input(const std::uint8_t* data, const std::size_t size)
+{
+   fuzz_input_t input;
+   if (0 == size) return input;
+
+   if (0 != (data[0] & 1)) input.mode = input.mode | slx::parse_mode::strict;
+   if (0 != (data[0] & 2)) input.mode = input.mode | slx::parse_mode::abbreviations;
+
+   const std::string_view text(reinterpret_cast<const char*>(data) + 1, size - 1);
+   const auto table_end = std::min(text.find('\0'), text.size());
+
+   // Option table; the names are reserved up front so that the views stay valid.
+   //
+   const auto table = text.substr(0, table_end);
+   const auto entry_count = static_cast<std::size_t>(std::count(table.begin(), table.end(), ',')) + 1;
+   input.names.reserve(2 * entry_count);
+   for (std::size_t begin = 0; begin < table.size();) {
+      auto entry = table.substr(begin, table.find(',', begin) - begin);
+      begin += entry.size() + 1;
+      const auto required = entry.ends_with('!');
+      if (required) entry.remove_suffix(1);
+      const auto slash = std::min(entry.find('/'), entry.size());
+      const auto& long_name = input.names.emplace_back(entry.substr(0, slash));
+      const auto& short_name = input.names.emplace_back(slash < entry.size() ? entry.substr(slash + 1) : std::string_view{});
+      input.options.emplace_back(long_name, short_name, required);
+   }
+
+   // Tokens, also joined into one command line string.
+   //
+   for (std::size_t begin = table_end + 1; begin <= text.size();) {
+      const auto end = std::min(text.find('\0', begin), text.size());
+      const auto& token = input.tokens.emplace_back(text.substr(begin, end - begin));
+      if (!input.command_line.empty()) input.command_line += ' ';
+      input.command_line += token;
+      begin = end + 1;
+   }
+   return input;
+}
+
+inline fuzz_argv_t make_fuzz_argv(std::vector<std::string>& tokens)
+{
+   fuzz_argv_t result;
+   result.argc = static_cast<int>(tokens.size());
+   if (tokens.empty()) return result;
+   result.argv = std::make_unique<char*[]>(tokens.size());
+   for (std::size_t i = 0; i < tokens.size(); ++i) result.argv[i] = tokens[i].data();
+   return result;
+}
+
+// Generates inputs close to the shapes that matter to the parser: names sharing prefixes,
+// joined and bundled options, quotes, '--', negative numbers and repeated keys.
+//
+inline std::string generate_fuzz_input(std::uint64_t& state)
+{
+   const auto next = [&](const std::uint64_t bound) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state % bound;
+   };
+   static constexpr std::array<std::string_view, 8> names{ "in", "input", "inputs", "i", "out", "o", "x", "v" };
+   static constexpr std::array<std::string_view, 10> values{
+      "", "-", "--", "-5", "-.5", "\"-quoted value\"", "\"", "=", "a=b", "value" };
+
+   std::string input(1, static_cast<char>(next(4)));
+   const auto option_count = next(8);
+   for (std::uint64_t i = 0; i < option_count; ++i) {
+      if (0 != i) input += ',';
+      input += names[next(names.size())];
+      input += '/';
+      input += names[next(names.size())].substr(0, 1);
+      if (0 == next(4)) input += '!';
+   }
+   input += '\0';
+   input += "fuzz.app";
+
+   const auto token_count = next(24);
+   for (std::uint64_t i = 0; i < token_count; ++i) {
+      input += '\0';
+      const auto name = names[next(names.size())];
+      switch (next(6)) {
+         case 0: input += "--"; input += name; break;
+         case 1: input += '-'; input += name.substr(0, 1); break;
+         case 2: input += "--"; input += name; input += '='; input += values[next(values.size())]; break;
+         case 3: input += '-'; input += names[next(names.size())].substr(0, 1); input += name; break;
+         case 4: input += "--"; input += name.substr(0, 1 + next(name.size())); break;
+         default: input += values[next(values.size())]; break;
+      }
+   }
+   return input;
+}
+
+inline void fuzz_check(const bool condition, const char* what)
+{
+   if (condition) return;
+   std::fprintf(stderr, "invariant broken: %s\n", what);
+   std::abort();
+}
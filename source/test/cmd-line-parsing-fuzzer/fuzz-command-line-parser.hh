@@ -0,0 +1,74 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// Copyright (c) William Berry
+// email: wberry.cpp@gmail.com
+// github: https://github.com/wsberry
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may freely use this source code and its projects in compliance with the License.
+//
+// You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License src distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// About:
+//  Implements a libFuzzer compatible fuzz target for cpp-argv-parser
+// -----------------------------------------------------------------------------------------
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <slx/cmd-line-parsing.hh>
+#include <slx/cmd-line-schema.hh>
+#include <slx/cmd-line-views.hh>
+#include <slx/cmd-line-lists.hh>
+#include <slx/cmd-line-stream.hh>
+#include <slx/cmd-line-tokenizer.hh>
+#include <slx/cmd-line-blob.hh>
+#include <slx/cmd-line-completions.hh>
+#include <slx/cmd-line-suggestions.hh>
+
+// A fuzz input decoded into an option table and a command line:
+//
+//    [mode][long/short,long/short!,...]\0[argv 0]\0[argv 1]\0...
+//
+// 'mode' selects parse_mode::strict (bit 0) and parse_mode::abbreviations (bit 1). A trailing
+// '!' marks an option as required. 'names' owns the strings viewed by 'options'.
+//
+struct fuzz_input_t final
+{
+   slx::parse_mode mode{slx::parse_mode::none};
+   std::vector<std::string> names{};
+   slx::command_line_options_t options{};
+   std::vector<std::string> tokens{};
+   std::string command_line{};
+};
+
+// The argv of a fuzz input, allocated with exactly argc entries (no terminating null) so that a
+// read past the last token is caught by AddressSanitizer.
+//
+struct fuzz_argv_t final
+{
+   std::unique_ptr<char*[]> argv{};
+   int argc{};
+};
+
+// Misc. Helper Functions.
+//
+inline fuzz_input_t decode_fuzz_input(const std::uint8_t* data, std::size_t size);
+inline fuzz_argv_t make_fuzz_argv(std::vector<std::string>& tokens);
+inline std::string generate_fuzz_input(std::uint64_t& state);
+inline void fuzz_check(bool condition, const char* what);
@@ -11,8 +11,58 @@ static std::vector<test_result_t> g_test_results;
 //
 static std::ofstream g_ofs("./test-command-line-results.md");
 
+// Every global allocation of the tester is counted so that a test can assert that a parse
+// did not allocate (see test_with_fixed_capacity_storage).
+//
+static std::atomic<std::size_t> g_allocations{};
+
+// Allocations larger than this fail, so that a test can make a parse fail on another thread
+// (see test_with_batch_of_records and test_with_layered_configuration).
+//
+static std::atomic<std::size_t> g_allocation_limit{ static_cast<std::size_t>(-1) };
+
+namespace {
+   void* counted_allocate(const std::size_t size)
+   {
+      g_allocations.fetch_add(1, std::memory_order_relaxed);
+      if (size > g_allocation_limit.load(std::memory_order_relaxed)) throw std::bad_alloc();
+      if (auto* p = std::malloc(0 == size ? 1 : size)) return p;
+      throw std::bad_alloc();
+   }
+
+   void counted_free(void* p) noexcept { std::free(p); }
+}
+
+void* operator new(const std::size_t size) { return counted_allocate(size); }
+void* operator new[](const std::size_t size) { return counted_allocate(size); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+
 void test_with_valid_args();
 void test_with_missing_args();
+void test_with_compile_time_schema();
+void test_with_zero_copy_views();
+void test_with_parser_contexts_in_parallel();
+void test_with_batch_of_records();
+void test_with_typed_values();
+void test_with_struct_binding();
+void test_with_response_files();
+void test_with_repeated_options();
+void test_with_fixed_capacity_storage();
+void test_with_published_snapshots();
+void test_with_layered_configuration();
+void test_with_command_line_string();
+void test_with_subcommands();
+void test_with_serialized_results();
+void test_with_streamed_tokens();
+void test_with_every_missing_option();
+void test_with_unknown_option_suggestions();
+void test_with_abbreviations();
+void test_with_joined_and_bundled_options();
+void test_with_deferred_process_parse();
+void test_with_instrumentation();
 
 static auto display_help = []() {
 
@@ -71,6 +121,27 @@ int main(/*int argc, char* argv[]*/) {
    std::cout << "Testing " << slx::product_about() << ":\n";
    test_with_valid_args();
    test_with_missing_args();
+   test_with_compile_time_schema();
+   test_with_zero_copy_views();
+   test_with_parser_contexts_in_parallel();
+   test_with_batch_of_records();
+   test_with_typed_values();
+   test_with_struct_binding();
+   test_with_response_files();
+   test_with_repeated_options();
+   test_with_fixed_capacity_storage();
+   test_with_published_snapshots();
+   test_with_layered_configuration();
+   test_with_command_line_string();
+   test_with_subcommands();
+   test_with_serialized_results();
+   test_with_streamed_tokens();
+   test_with_every_missing_option();
+   test_with_unknown_option_suggestions();
+   test_with_abbreviations();
+   test_with_joined_and_bundled_options();
+   test_with_deferred_process_parse();
+   test_with_instrumentation();
 }
 
 
@@ -174,6 +245,1449 @@ void test_with_missing_args()
 
 }
 
+void test_with_compile_time_schema()
+{
+   // The schema is built at compile time; matching a token is a single hash probe.
+   //
+   static constexpr auto options = slx::make_command_line_schema({ {"in", "i", /*required:*/ true}, {"out", "o", false} });
+   static_assert(0 == options.match("--in") && 0 == options.match("-i"));
+   static_assert(1 == options.match("--out") && 1 == options.match("-o"));
+   static_assert(options.npos == options.match("--i") && options.npos == options.match("-in"));
+
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Parsing with a compile time schema should SUCCEED."_test = [&]
+#endif
+   {
+      slx::clear_command_line_options();
+
+      constexpr int argc{ 5 };
+      const char* argv_[argc] = { "mock.app", "--out", "\"output.json\"", "-i", "input.json" };
+      const auto argv = const_cast<char**>(argv_);
+
+      auto r = slx::parse_command_line_args<false>(options, argc, argv, display_help);
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Parsing with a compile time schema should SUCCEED."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(0 == r.count("app")).value_
+         && expect("input.json" == r["in"]).value_
+         && expect("output.json" == r["out"]).value_;
+#else
+      create_log_report_result("Parsing with a compile time schema should SUCCEED.");
+      g_test_results.back().succeeded =
+         (0 == r.count("app"))
+         && ("input.json" == r["in"])
+         && ("output.json" == r["out"]);
+#endif
+   };
+}
+
+void test_with_zero_copy_views()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Parsing into views should reference argv without copying."_test = [&]
+#endif
+   {
+      static constexpr auto options = slx::make_command_line_schema({ {"in", "i", /*required:*/ true}, {"out", "o", false} });
+
+      constexpr int argc{ 5 };
+      const char* argv_[argc] = { "mock.app", "-o", "\"output.json\"", "--in", "input.json" };
+      const auto argv = const_cast<char**>(argv_);
+
+      const auto r = slx::parse_command_line_views(options, argc, argv, display_help);
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Parsing into views should reference argv without copying."_test.name);
+
+      g_test_results.back().succeeded =
+         expect("mock.app" == r["app"]).value_
+         && expect("output.json" == slx::get_command_line_option(r, "out")).value_
+         && expect(argv_[2] + 1 == r["out"].data()).value_
+         && expect(argv_[4] == r["in"].data()).value_
+         && expect(!slx::command_line_option(r, "ignored")).value_;
+#else
+      create_log_report_result("Parsing into views should reference argv without copying.");
+      g_test_results.back().succeeded =
+         ("mock.app" == r["app"])
+         && ("output.json" == slx::get_command_line_option(r, "out"))
+         && (argv_[2] + 1 == r["out"].data())
+         && (argv_[4] == r["in"].data())
+         && !slx::command_line_option(r, "ignored");
+#endif
+   };
+}
+
+void test_with_parser_contexts_in_parallel()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Parsing with a parser_context per thread should not interfere."_test = [&]
+#endif
+   {
+      const slx::command_line_options_t options{ {"in", "i", /*required:*/ true}, {"out", "o", false} };
+
+      // Each worker owns its context and parses its own argument vectors; the options are shared
+      // read only. Any cross talk between the workers shows up as a mismatched value.
+      //
+      constexpr auto workers = 8;
+      constexpr auto parses_per_worker = 5000;
+      std::array<int, workers> mismatches{};
+      std::vector<std::thread> threads;
+
+      for (auto w = 0; w < workers; ++w) {
+         threads.emplace_back([&, w]() {
+            slx::parser_context context;
+            for (auto n = 0; n < parses_per_worker; ++n) {
+               const auto in = std::to_string(w) + "-" + std::to_string(n);
+               const char* argv_[] = { "worker.app", "--in", in.c_str(), (0 == n % 2) ? "-o" : "--ignored", "out" };
+               const auto& r = slx::parse_command_line_args(context, options, 5, const_cast<char**>(argv_), {});
+               const auto expected_size = (0 == n % 2) ? 3u : 2u;
+               if (r.size() != expected_size || context.option("in") != in) ++mismatches[w];
+            }
+         });
+      }
+      for (auto& t : threads) t.join();
+
+      auto total_mismatches = 0;
+      for (const auto m : mismatches) total_mismatches += m;
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Parsing with a parser_context per thread should not interfere."_test.name);
+
+      g_test_results.back().succeeded = expect(0 == total_mismatches).value_;
+#else
+      create_log_report_result("Parsing with a parser_context per thread should not interfere.");
+      g_test_results.back().succeeded = (0 == total_mismatches);
+#endif
+   };
+}
+
+void test_with_batch_of_records()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Parsing a batch of records should produce one column per option."_test = [&]
+#endif
+   {
+      const slx::command_line_options_t options{ {"in", "i", /*required:*/ true}, {"out", "o", false} };
+
+      // Three records (newline separated) of NUL separated tokens; the second is missing "--in".
+      //
+      using namespace std::string_view_literals;
+      constexpr auto records =
+         "a.app\0--in\0one.json\0-o\0\"out.json\"\n"
+         "b.app\0-o\0two.json\n"
+         "c.app\0-i\0three.json\n"sv;
+
+      const auto batch = slx::parse_command_line_batch(options, records, { '\0', '\n', /*threads:*/ 4 });
+
+      // An exception on a worker thread is rethrown on the caller instead of terminating.
+      //
+      std::string many_records;
+      for (auto r = 0; r < 20000; ++r) many_records.append("app\0-i\0value\n"sv);
+      auto rethrown = false;
+      g_allocation_limit = 1 << 14;
+      try { (void)slx::parse_command_line_batch(options, many_records, { '\0', '\n', /*threads:*/ 4 }); }
+      catch (const std::bad_alloc&) { rethrown = true; }
+      g_allocation_limit = static_cast<std::size_t>(-1);
+      const auto recovered = rethrown && 20000 == slx::parse_command_line_batch(options, many_records, { '\0', '\n', 4 }).size();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Parsing a batch of records should produce one column per option."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(3 == batch.size()).value_
+         && expect(2 == batch.columns().size()).value_
+         && expect("one.json" == batch.value(0, 0) && "out.json" == batch.value(0, 1)).value_
+         && expect(!batch.contains(1, 0) && "two.json" == batch.value(1, 1)).value_
+         && expect("three.json" == batch.value(2, 0) && !batch.contains(2, 1)).value_
+         && expect(!batch.is_incomplete(0) && batch.is_incomplete(1) && !batch.is_incomplete(2)).value_
+         && expect(recovered).value_;
+#else
+      create_log_report_result("Parsing a batch of records should produce one column per option.");
+      g_test_results.back().succeeded =
+         (3 == batch.size())
+         && (2 == batch.columns().size())
+         && ("one.json" == batch.value(0, 0) && "out.json" == batch.value(0, 1))
+         && (!batch.contains(1, 0) && "two.json" == batch.value(1, 1))
+         && ("three.json" == batch.value(2, 0) && !batch.contains(2, 1))
+         && (!batch.is_incomplete(0) && batch.is_incomplete(1) && !batch.is_incomplete(2))
+         && recovered;
+#endif
+   };
+}
+
+void test_with_typed_values()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Typed options should be converted once and report invalid values."_test = [&]
+#endif
+   {
+      using slx::option_type;
+      static constexpr auto options = slx::make_command_line_schema({
+         {"threads", "j", /*required:*/ true, option_type::integer},
+         {"timeout", "t", false, option_type::duration},
+         {"cache", "c", false, option_type::byte_size},
+         {"mode", "m", false, option_type::enumeration, "fast|safe"},
+         {"ratio", "r", false, option_type::floating_point}
+      });
+
+      constexpr int argc{ 11 };
+      const char* argv_[argc] = { "mock.app", "-j", "64", "--timeout", "250ms", "-c", "2M", "-m", "safe", "-r", "1/2" };
+      const auto argv = const_cast<char**>(argv_);
+
+      auto help_displayed = false;
+      const auto r = slx::parse_command_line_views(options, argc, argv, [&]() { help_displayed = true; });
+
+      const auto ratio_is_invalid = 1 == r.error_count()
+         && 4 == r.errors_begin()->index && slx::option_error::invalid_value == r.errors_begin()->error;
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Typed options should be converted once and report invalid values."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(64 == r.get<int>("threads")).value_
+         && expect(std::chrono::milliseconds(250) == r.get<std::chrono::milliseconds>("timeout")).value_
+         && expect(2u * 1024 * 1024 == r.get<std::size_t>("cache")).value_
+         && expect(1 == r.get<int>("mode")).value_
+         && expect(0.5 == r.get<double>("ratio", 0.5)).value_
+         && expect(ratio_is_invalid && help_displayed).value_;
+#else
+      create_log_report_result("Typed options should be converted once and report invalid values.");
+      g_test_results.back().succeeded =
+         (64 == r.get<int>("threads"))
+         && (std::chrono::milliseconds(250) == r.get<std::chrono::milliseconds>("timeout"))
+         && (2u * 1024 * 1024 == r.get<std::size_t>("cache"))
+         && (1 == r.get<int>("mode"))
+         && (0.5 == r.get<double>("ratio", 0.5))
+         && (ratio_is_invalid && help_displayed);
+#endif
+   };
+}
+
+struct binding_config_t final
+{
+   std::string in;
+   std::string out{ "result.json" };
+   int threads{ 8 };
+   bool verbose{};
+   std::uint8_t level{ 1 };
+   enum class mode_t { fast, safe } mode{ mode_t::fast };
+};
+
+void test_with_struct_binding()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Parsing into a bound struct should fill its fields."_test = [&]
+#endif
+   {
+      static constexpr auto binding = slx::make_command_line_binding(
+         slx::bind_option("in", "i", /*required:*/ true, &binding_config_t::in),
+         slx::bind_option("out", "o", false, &binding_config_t::out),
+         slx::bind_option("threads", "j", false, &binding_config_t::threads),
+         slx::bind_option("verbose", "v", false, &binding_config_t::verbose),
+         slx::bind_option("level", "l", false, &binding_config_t::level),
+         slx::bind_option("mode", "m", false, &binding_config_t::mode, "fast|safe"));
+
+      constexpr int argc{ 10 };
+      const char* argv_[argc] = { "mock.app", "-v", "--in", "input.json", "-j", "16", "-l", "200", "-m", "safe" };
+      const auto argv = const_cast<char**>(argv_);
+
+      binding_config_t config;
+      const auto parsed = slx::parse_command_line_args(binding, config, argc, argv, display_help);
+
+      // A value outside the range of its field is reported instead of being truncated.
+      //
+      constexpr int range_argc{ 5 };
+      const char* range_argv_[range_argc] = { "mock.app", "--in", "input.json", "-l", "300" };
+      const auto range_argv = const_cast<char**>(range_argv_);
+      binding_config_t range_config;
+      auto helps = 0;
+      const auto range_parsed = slx::parse_command_line_args(binding, range_config, range_argc, range_argv, [&] { ++helps; });
+      auto views = slx::parse_command_line_views<false>(binding.schema(), range_argc, range_argv, nullptr);
+      const auto in_range = views.get<int>("level");
+      const auto out_of_range = views.get<std::uint8_t>("level", std::uint8_t{ 7 });
+      const auto fits = views.require_fits<std::uint8_t>(4);
+      const auto range_ok =
+         !range_parsed && 1 == helps && 1 == range_config.level && "input.json" == range_config.in
+         && 300 == in_range && 7 == out_of_range && !fits && 1 == views.error_count()
+         && slx::option_error::invalid_value == views.errors_begin()->error;
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Parsing into a bound struct should fill its fields."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(parsed).value_
+         && expect("input.json" == config.in).value_
+         && expect("result.json" == config.out).value_
+         && expect(16 == config.threads).value_
+         && expect(config.verbose).value_
+         && expect(200 == config.level && binding_config_t::mode_t::safe == config.mode).value_
+         && expect(range_ok).value_;
+#else
+      create_log_report_result("Parsing into a bound struct should fill its fields.");
+      g_test_results.back().succeeded =
+         parsed
+         && ("input.json" == config.in)
+         && ("result.json" == config.out)
+         && (16 == config.threads)
+         && config.verbose
+         && (200 == config.level && binding_config_t::mode_t::safe == config.mode)
+         && range_ok;
+#endif
+   };
+}
+
+void test_with_response_files()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Response files should be expanded in place of '@file' tokens."_test = [&]
+#endif
+   {
+      // A response file that names a nested response file; quotes and escapes are removed in place.
+      //
+      const auto directory = std::filesystem::temp_directory_path();
+      const auto nested_path = (directory / "cpp-argv-parser-nested.rsp").string();
+      const auto main_path = (directory / "cpp-argv-parser-main.rsp").string();
+
+      std::ofstream(nested_path) << "-o 'out file.json'\n";
+      std::ofstream(main_path) << R"(--in "C:\\data\\in.json" ')" << '@' << nested_path << "'\n--ignored\\ token\n";
+
+      const auto main_token = "@" + main_path;
+      constexpr int argc{ 3 };
+      const char* argv_[argc] = { "app.exe", main_token.c_str(), "@missing.rsp" };
+      const auto argv = const_cast<char**>(argv_);
+
+      slx::command_line_expansion expansion;
+      expansion.expand(argc, argv);
+
+      const slx::command_line_options_t options{ {"in", "i", /*required:*/ true}, {"out", "o", false} };
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, argc, argv, display_help, slx::parse_mode::response_files);
+
+      // The copy shares the mappings of the parse, so its values outlive the original result.
+      //
+      constexpr auto schema = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+      const auto views = [&] {
+         const auto parsed = slx::parse_command_line_views(schema, argc, argv, display_help,
+                                                           slx::parse_mode::response_files);
+         return slx::command_line_views<2>(parsed);
+      }();
+
+      const auto expanded =
+         7 == expansion.size()
+         && "--ignored token" == expansion[5]
+         && "@missing.rsp" == expansion[6]
+         && 1 == expansion.failures().size();
+
+      // A file that names itself, and two files that name each other, are expanded once and
+      // the re-entry is reported; the token limit stops the expansion.
+      //
+      const auto self_path = (directory / "cpp-argv-parser-self.rsp").string();
+      const auto first_path = (directory / "cpp-argv-parser-first.rsp").string();
+      const auto second_path = (directory / "cpp-argv-parser-second.rsp").string();
+      std::ofstream(self_path) << "-v @" << self_path << " @" << self_path << '\n';
+      std::ofstream(first_path) << "--first @" << second_path << '\n';
+      std::ofstream(second_path) << "--second @" << first_path << '\n';
+
+      const auto self_token = "@" + self_path;
+      const auto first_token = "@" + first_path;
+      constexpr int cycle_argc{ 3 };
+      const char* cycle_argv_[cycle_argc] = { "app.exe", self_token.c_str(), first_token.c_str() };
+      const auto cycle_argv = const_cast<char**>(cycle_argv_);
+      slx::command_line_expansion cycles;
+      cycles.expand(cycle_argc, cycle_argv);
+      const auto cycles_rejected =
+         std::vector<std::string_view>{ "app.exe", "-v", self_token, self_token, "--first", "--second", first_token }
+            == std::vector<std::string_view>(cycles.begin(), cycles.end())
+         && std::vector<std::string>{ self_path, self_path, first_path } == cycles.failures();
+
+      slx::command_line_expansion limited;
+      limited.expand(cycle_argc, cycle_argv, slx::command_line_expansion::default_max_depth, /*max_tokens:*/ 2);
+      const auto limited_ok = 2 == limited.size() && !limited.failures().empty();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Response files should be expanded in place of '@file' tokens."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(expanded).value_
+         && expect(cycles_rejected).value_
+         && expect(limited_ok).value_
+         && expect(R"(C:\data\in.json)" == context.option("in") && "out file.json" == context.option("out")).value_
+         && expect(R"(C:\data\in.json)" == views["in"] && "out file.json" == views["out"]).value_;
+#else
+      create_log_report_result("Response files should be expanded in place of '@file' tokens.");
+      g_test_results.back().succeeded =
+         expanded
+         && cycles_rejected
+         && limited_ok
+         && (R"(C:\data\in.json)" == context.option("in") && "out file.json" == context.option("out"))
+         && (R"(C:\data\in.json)" == views["in"] && "out file.json" == views["out"]);
+#endif
+      std::filesystem::remove(nested_path);
+      std::filesystem::remove(main_path);
+      std::filesystem::remove(self_path);
+      std::filesystem::remove(first_path);
+      std::filesystem::remove(second_path);
+   };
+}
+
+void test_with_repeated_options()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Repeated and multi-valued options should keep every value."_test = [&]
+#endif
+   {
+      // Counts the allocations that reach the heap.
+      //
+      struct counting_resource final : std::pmr::memory_resource {
+         std::size_t allocations{};
+         void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+         }
+         void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+         }
+         bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+      };
+
+      constexpr auto options = slx::make_command_line_schema({
+         {"include", "I", false, {}, {}, slx::option_arity::repeated},
+         {"inputs", "", true, {}, {}, slx::option_arity::multiple},
+         {"out", "o", false} });
+
+      std::vector<const char*> argv_{ "app.exe", "-I", "a", "-o", "first.json", "-I", "b", "--inputs" };
+      std::vector<std::string> inputs;
+      for (auto i = 0; i < 20000; ++i) inputs.push_back("input-" + std::to_string(i) + ".json");
+      for (const auto& input : inputs) argv_.push_back(input.c_str());
+      argv_.push_back("-o");
+      argv_.push_back("second.json");
+      const auto argv = const_cast<char**>(argv_.data());
+
+      counting_resource upstream;
+      slx::command_line_lists cmd_line(nullptr, 0, &upstream);
+      slx::parse_command_line_lists(cmd_line, options, static_cast<int>(argv_.size()), argv, display_help);
+
+      const auto includes = cmd_line.values("include");
+      const auto parsed_inputs = cmd_line.values("inputs");
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Repeated and multi-valued options should keep every value."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(2 == includes.size() && "a" == includes[0] && "b" == includes[1]).value_
+         && expect(20000 == parsed_inputs.size() && "input-19999.json" == parsed_inputs.back()).value_
+         && expect(1 == cmd_line.values("out").size() && "second.json" == cmd_line["out"]).value_
+         && expect(upstream.allocations < 8).value_;
+#else
+      create_log_report_result("Repeated and multi-valued options should keep every value.");
+      g_test_results.back().succeeded =
+         (2 == includes.size() && "a" == includes[0] && "b" == includes[1])
+         && (20000 == parsed_inputs.size() && "input-19999.json" == parsed_inputs.back())
+         && (1 == cmd_line.values("out").size() && "second.json" == cmd_line["out"])
+         && (upstream.allocations < 8);
+#endif
+   };
+}
+
+void test_with_fixed_capacity_storage()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "A fixed capacity parse should report errors instead of allocating."_test = [&]
+#endif
+   {
+      const slx::command_line_options_t options{ {"in", "i", /*required:*/ true}, {"out", "o", false} };
+      constexpr int argc{ 5 };
+      const char* argv_[argc] = { "app.exe", "--in", "input.json", "-o", "result.json" };
+      const auto argv = const_cast<char**>(argv_);
+
+      alignas(std::max_align_t) std::array<std::byte, slx::command_line_lists::required_capacity(2, argc)> storage{};
+      slx::command_line_lists cmd_line(storage);
+      auto allocations = g_allocations.load();
+      const auto parsed = slx::try_parse_command_line_lists(cmd_line, options, argc, argv);
+      auto allocation_free = allocations == g_allocations.load();
+      const auto parsed_ok = slx::parse_status::ok == parsed
+         && "input.json" == cmd_line["in"] && "result.json" == cmd_line["out"];
+
+      constexpr int missing_argc{ 3 };
+      const char* missing_argv_[missing_argc] = { "app.exe", "-o", "result.json" };
+      allocations = g_allocations.load();
+      const auto missing = slx::try_parse_command_line_lists(cmd_line, options, missing_argc, const_cast<char**>(missing_argv_));
+      allocation_free = allocation_free && allocations == g_allocations.load();
+
+      std::array<std::byte, 32> small{};
+      slx::command_line_lists too_small(small);
+      allocations = g_allocations.load();
+      const auto overflow = slx::try_parse_command_line_lists(too_small, options, argc, argv);
+      allocation_free = allocation_free && allocations == g_allocations.load();
+
+      // A schema, and tables larger than the inline words of the presence bitset (300 options,
+      // every 50th required), are parsed without allocating too.
+      //
+      constexpr auto schema = slx::make_command_line_schema({ {"in", "i", true}, {"out", "o", false} });
+      allocations = g_allocations.load();
+      const auto schema_parsed = slx::try_parse_command_line_lists(cmd_line, schema, argc, argv);
+      allocation_free = allocation_free && allocations == g_allocations.load();
+      const auto schema_ok = slx::parse_status::ok == schema_parsed && "result.json" == cmd_line["out"];
+
+      constexpr std::size_t large_size{ 300 };
+      std::vector<std::string> names;
+      for (std::size_t i = 0; i < large_size; ++i) names.push_back(fmt::format("option-{}", i));
+      slx::command_line_options_t large_options;
+      auto large_specs = std::make_unique<std::array<slx::option_spec, large_size>>();
+      for (std::size_t i = 0; i < large_size; ++i) {
+         large_options.emplace_back(names[i], "", 0 == i % 50);
+         (*large_specs)[i] = slx::option_spec{ names[i], "", 0 == i % 50 };
+      }
+      const auto large_schema = std::make_unique<slx::command_line_schema<large_size>>(*large_specs);
+
+      constexpr int large_argc{ 7 };
+      const char* large_argv_[large_argc] = { "app.exe", "--option-299", "last", "--option-0", "first", "--option-150", "middle" };
+      const auto large_argv = const_cast<char**>(large_argv_);
+      alignas(std::max_align_t) std::array<std::byte, slx::command_line_lists::required_capacity(large_size, large_argc)> large_storage{};
+      slx::command_line_lists large_lists(large_storage);
+
+      allocations = g_allocations.load();
+      const auto large_missing = slx::try_parse_command_line_lists(large_lists, large_options, large_argc, large_argv);
+      const auto large_schema_missing = slx::try_parse_command_line_lists(large_lists, *large_schema, large_argc, large_argv);
+      allocation_free = allocation_free && allocations == g_allocations.load();
+      const auto large_ok =
+         slx::parse_status::missing_required == large_missing
+         && slx::parse_status::missing_required == large_schema_missing
+         && "last" == large_lists["option-299"] && "middle" == large_lists["option-150"];
+
+      // Bundled flags store one value per flag, more than one per token: storage sized by
+      // argc is reported as too small, and storage sized by max_value_count fits.
+      //
+      const slx::command_line_options_t flags{ {"all", "a", false}, {"b", "b", false}, {"c", "c", false}, {"d", "d", false} };
+      constexpr int bundled_argc{ 3 };
+      const char* bundled_argv_[bundled_argc] = { "app.exe", "-abcd", "-abcd" };
+      const auto bundled_argv = const_cast<char**>(bundled_argv_);
+      alignas(std::max_align_t) std::array<std::byte, slx::command_line_lists::required_capacity(4, bundled_argc)> argc_storage{};
+      alignas(std::max_align_t) std::array<std::byte, slx::command_line_lists::required_capacity(4, 9)> bundled_storage{};
+      slx::command_line_lists argc_lists(argc_storage);
+      slx::command_line_lists bundled_lists(bundled_storage);
+      slx::command_line_lists heap_lists;
+      slx::parse_command_line_lists(heap_lists, flags, bundled_argc, bundled_argv, nullptr);
+      const auto bundled_ok =
+         9 == slx::command_line_lists::max_value_count(bundled_argc, bundled_argv)
+         && slx::parse_status::out_of_capacity == slx::try_parse_command_line_lists(argc_lists, flags, bundled_argc, bundled_argv)
+         && slx::parse_status::ok == slx::try_parse_command_line_lists(bundled_lists, flags, bundled_argc, bundled_argv)
+         && 8 == bundled_lists.value_count() && 2 == bundled_lists.values("d").size()
+         && 8 == heap_lists.value_count();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("A fixed capacity parse should report errors instead of allocating."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(parsed_ok).value_
+         && expect(slx::parse_status::missing_required == missing).value_
+         && expect(slx::parse_status::out_of_capacity == overflow && 0 == too_small.size()).value_
+         && expect(schema_ok).value_
+         && expect(large_ok).value_
+         && expect(bundled_ok).value_
+         && expect(allocation_free).value_;
+#else
+      create_log_report_result("A fixed capacity parse should report errors instead of allocating.");
+      g_test_results.back().succeeded =
+         parsed_ok
+         && (slx::parse_status::missing_required == missing)
+         && (slx::parse_status::out_of_capacity == overflow && 0 == too_small.size())
+         && schema_ok
+         && large_ok
+         && bundled_ok
+         && allocation_free;
+#endif
+   };
+}
+
+void test_with_published_snapshots()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Published snapshots should stay valid while new ones are swapped in."_test = [&]
+#endif
+   {
+      slx::command_line_options_t options{ {"in", "i", /*required:*/ true}, {"out", "o", false} };
+      constexpr int argc{ 5 };
+      const char* argv_[argc] = { "app.exe", "--in", "first.json", "-o", "first.out" };
+      slx::parse_command_line_args(options, argc, const_cast<char**>(argv_), display_help);
+
+      // Hold the first snapshot while a writer publishes new ones; every snapshot a reader sees
+      // must be complete (both options from the same publication).
+      //
+      const auto first = slx::command_line_snapshot();
+      std::atomic<bool> done{};
+      std::atomic<bool> consistent{ true };
+
+      std::vector<std::thread> readers;
+      for (auto t = 0; t < 4; ++t) {
+         readers.emplace_back([&] {
+            while (!done.load()) {
+               const auto args = slx::command_line_snapshot();
+               const auto in = args->find("in");
+               const auto out = args->find("out");
+               if (in == args->end() || out == args->end()) {
+                  consistent = false;
+                  continue;
+               }
+               const std::string_view in_stem = in->second, out_stem = out->second;
+               if (in_stem.substr(0, in_stem.size() - 5) != out_stem.substr(0, out_stem.size() - 4)) consistent = false;
+
+               // The legacy accessors read the published snapshots too.
+               //
+               if (!slx::command_line_option("out") || !slx::get_command_line_option("in").ends_with(".json")) consistent = false;
+            }
+         });
+      }
+
+      for (auto i = 0; i < 1000; ++i) {
+         std::string value{ "v" };
+         value += std::to_string(i);
+         slx::publish_command_line_snapshot({ {"in", value + ".json"}, {"out", value + ".out"} });
+      }
+      done = true;
+      for (auto& reader : readers) reader.join();
+
+      const auto last = slx::command_line_snapshot();
+
+      slx::clear_command_line_options();
+      const auto cleared = slx::command_line_snapshot()->empty() && !slx::command_line_option("in")
+                           && slx::get_command_line_option("in").empty() && slx::get_command_line_args().empty();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Published snapshots should stay valid while new ones are swapped in."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(consistent.load()).value_
+         && expect("first.json" == first->at("in") && "first.out" == first->at("out")).value_
+         && expect("v999.json" == last->at("in") && "v999.out" == last->at("out")).value_
+         && expect(cleared).value_;
+#else
+      create_log_report_result("Published snapshots should stay valid while new ones are swapped in.");
+      g_test_results.back().succeeded =
+         consistent.load()
+         && ("first.json" == first->at("in") && "first.out" == first->at("out"))
+         && ("v999.json" == last->at("in") && "v999.out" == last->at("out"))
+         && cleared;
+#endif
+   };
+}
+
+void test_with_layered_configuration()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "The command line, environment and config file should be merged in order."_test = [&]
+#endif
+   {
+      const auto config_path = (std::filesystem::temp_directory_path() / "cpp-argv-parser-test.conf").string();
+      std::ofstream(config_path) << "# test configuration\nin = file.json\nout = \"file.out\"\nthreads = 4\n";
+
+#if defined(_WIN32)
+      _putenv_s("SLX_TEST_OUT", "env.out");
+#else
+      setenv("SLX_TEST_OUT", "env.out", 1);
+#endif
+
+      constexpr int argc{ 3 };
+      const char* argv_[argc] = { "app.exe", "--in", "argv.json" };
+      const auto argv = const_cast<char**>(argv_);
+      slx::command_line_resolver config({ {"in", "i", true}, {"out", "o", false}, {"threads", "j", false} },
+                                        "SLX_TEST_", config_path);
+      const auto first = config.resolve(argc, argv, display_help);
+
+      const auto merged =
+         "argv.json" == first->at("in") && slx::option_source::command_line == config.source("in")
+         && "env.out" == first->at("out") && slx::option_source::environment == config.source("out")
+         && "4" == first->at("threads") && slx::option_source::config_file == config.source("threads")
+         && first == slx::command_line_snapshot();
+
+      // Only the changed option is republished; an unchanged file publishes nothing.
+      //
+      std::ofstream(config_path) << "in = file.json\nout = file.out\nthreads = 8\n";
+      const auto reloaded = config.reload() && "8" == slx::command_line_snapshot()->at("threads");
+      const auto unchanged = !config.reload() && "4" == first->at("threads");
+
+      auto watched = true;
+      auto survived = true;
+#if defined(__linux__)
+      std::atomic<int> errors{};
+      watched = config.watch([&](const std::exception_ptr& error) { errors += error ? 1 : 0; });
+      std::ofstream(config_path) << "threads = 16\n";
+      for (auto i = 0; i < 200 && "16" != slx::command_line_snapshot()->at("threads"); ++i) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      watched = watched && "16" == slx::command_line_snapshot()->at("threads");
+
+      // A reload that throws on the watcher thread is reported; the previous layer is kept and
+      // the watcher goes on to the next change.
+      //
+      const auto huge_value = std::string(1 << 20, 'x');
+      g_allocation_limit = 1 << 19;
+      std::ofstream(config_path) << "threads = " << huge_value << "\n";
+      for (auto i = 0; i < 200 && 0 == errors; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      g_allocation_limit = static_cast<std::size_t>(-1);
+      survived = 0 != errors && "16" == slx::command_line_snapshot()->at("threads")
+                 && slx::option_source::config_file == config.source("threads");
+      std::ofstream(config_path) << "threads = 32\n";
+      for (auto i = 0; i < 200 && "32" != slx::command_line_snapshot()->at("threads"); ++i) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      survived = survived && "32" == slx::command_line_snapshot()->at("threads");
+      config.stop();
+#endif
+
+      // Without a prefix the environment is not read ('slx-test-out' would be SLX_TEST_OUT).
+      //
+      slx::command_line_resolver unprefixed({ {"in", "i", true}, {"slx-test-out", "", false}, {"path", "", false} });
+      const auto resolved = unprefixed.resolve(argc, argv, display_help);
+      const auto no_environment =
+         !resolved->contains("slx-test-out") && !resolved->contains("path")
+         && slx::option_source::none == unprefixed.source("slx-test-out") && slx::option_source::none == unprefixed.source("path");
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("The command line, environment and config file should be merged in order."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(merged).value_
+         && expect(reloaded && unchanged).value_
+         && expect(watched).value_
+         && expect(survived).value_
+         && expect(no_environment).value_;
+#else
+      create_log_report_result("The command line, environment and config file should be merged in order.");
+      g_test_results.back().succeeded = merged && reloaded && unchanged && watched && survived && no_environment;
+#endif
+      std::filesystem::remove(config_path);
+   };
+}
+
+void test_with_command_line_string()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "A single command line string should be split as argv would be."_test = [&]
+#endif
+   {
+      // The value of --long is longer than one AVX2 block so that the vector scan is used.
+      //
+      const std::string long_value(70, 'v');
+      const auto line = R"(  tool.exe --in "my file.json" --pattern "-x y" -o a"b c"d --name it\'s 'single "q"' --path "C:\\a \"b\"")"
+                        + std::string(" --long ") + long_value + "\t\n";
+
+      const slx::command_line_tokens tokens(line);
+      const auto split =
+         14 == tokens.size()
+         && "tool.exe" == tokens[0]
+         && R"("my file.json")" == tokens[2]
+         && "ab cd" == tokens[6]
+         && "it's" == tokens[8]
+         && R"(single "q")" == tokens[9]
+         && long_value == tokens[13];
+
+      const slx::command_line_options_t options{
+         {"in", "i", /*required:*/ true}, {"pattern", "p", false}, {"out", "o", false}, {"name", "n", false},
+         {"path", "", false}, {"long", "l", false} };
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, tokens, display_help);
+
+      constexpr auto schema = slx::make_command_line_schema({ {"in", "i", true}, {"pattern", "p", false} });
+      const auto views = slx::parse_command_line_views(schema, tokens, display_help);
+
+      const auto parsed =
+         "my file.json" == context.option("in")
+         && "-x y" == context.option("pattern")
+         && "ab cd" == context.option("out")
+         && R"(C:\a "b")" == context.option("path")
+         && long_value == context.option("long")
+         && "my file.json" == views["in"] && "-x y" == views["pattern"];
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("A single command line string should be split as argv would be."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(split).value_
+         && expect(parsed).value_;
+#else
+      create_log_report_result("A single command line string should be split as argv would be.");
+      g_test_results.back().succeeded = split && parsed;
+#endif
+   };
+}
+
+void test_with_subcommands()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Only the selected subcommand's schema should be built and matched."_test = [&]
+#endif
+   {
+      std::array<int, 3> schemas_built{};
+      std::array<int, 3> helps{};
+      std::string message;
+      std::string remote;
+
+      const auto commands = slx::make_command_line_subcommands(
+         slx::subcommand<"commit">(
+            [&] { ++schemas_built[0]; return slx::make_command_line_schema({ {"message", "m", true}, {"all", "a", false} }); },
+            [&](const auto& cmd_line) { message = cmd_line["message"]; return 7; },
+            [&] { ++helps[0]; }),
+         slx::subcommand<"checkout">(
+            [&] { ++schemas_built[1]; return slx::make_command_line_schema({ {"branch", "b", true} }); },
+            [](const auto&) {},
+            [&] { ++helps[1]; }),
+         slx::subcommand_group<"remote">(
+            slx::make_command_line_subcommands(
+               slx::subcommand<"add">(
+                  [&] { ++schemas_built[2]; return slx::make_command_line_schema({ {"name", "n", true} }); },
+                  [&](const auto& cmd_line) { remote = cmd_line["name"]; })),
+            [&] { ++helps[2]; }));
+
+      static_assert(1 == decltype(commands)::find("checkout"));
+      static_assert(decltype(commands)::npos == decltype(commands)::find("check"));
+
+      const char* commit_argv[4] = { "app.exe", "commit", "-m", "fix" };
+      const char* invalid_argv[3] = { "app.exe", "commit", "--all" };
+      const char* remote_argv[5] = { "app.exe", "remote", "add", "--name", "origin" };
+      const char* remote_unknown_argv[3] = { "app.exe", "remote", "rm" };
+      const char* unknown_argv[2] = { "app.exe", "comm" };
+
+      auto top_level_helps = 0;
+      const auto help = [&] { ++top_level_helps; };
+
+      const auto dispatched =
+         7 == commands.dispatch(4, const_cast<char**>(commit_argv), help) && "fix" == message
+         && EXIT_FAILURE == commands.dispatch(3, const_cast<char**>(invalid_argv), help)
+         && EXIT_SUCCESS == commands.dispatch(5, const_cast<char**>(remote_argv), help)
+         && "origin" == remote
+         && EXIT_FAILURE == commands.dispatch(3, const_cast<char**>(remote_unknown_argv), help)
+         && EXIT_FAILURE == commands.dispatch(2, const_cast<char**>(unknown_argv), help);
+
+      // The 'checkout' schema was never built; help was scoped to the subcommand that failed.
+      //
+      const auto scoped =
+         2 == schemas_built[0] && 0 == schemas_built[1] && 1 == schemas_built[2]
+         && 1 == helps[0] && 0 == helps[1] && 1 == helps[2] && 1 == top_level_helps
+         && commands.publish_help("checkout") && 1 == helps[1] && !commands.publish_help("merge");
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Only the selected subcommand's schema should be built and matched."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(dispatched).value_
+         && expect(scoped).value_;
+#else
+      create_log_report_result("Only the selected subcommand's schema should be built and matched.");
+      g_test_results.back().succeeded = dispatched && scoped;
+#endif
+   };
+}
+
+void test_with_serialized_results()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Serialized results should be queried in place and validated."_test = [&]
+#endif
+   {
+      constexpr int argc{ 7 };
+      const char* argv_[argc] = { "app.exe", "--in", "file.json", "-o", "", "-j", "64" };
+      const auto argv = const_cast<char**>(argv_);
+      const slx::command_line_options_t options{ {"in", "i", true}, {"out", "o", false}, {"threads", "j", false} };
+      slx::parser_context context;
+      const auto& results = slx::parse_command_line_args(context, options, argc, argv, display_help);
+
+      const auto blob = slx::make_command_line_blob(results);
+      const slx::command_line_blob cmd_line(blob);
+
+      const auto in_place =
+         cmd_line.is_valid() && results.size() == cmd_line.size()
+         && "file.json" == cmd_line["in"] && "64" == cmd_line.option("threads") && "app.exe" == cmd_line["app"]
+         && cmd_line.has_option("out") && cmd_line["out"].empty() && !cmd_line.contains("missing")
+         && reinterpret_cast<const char*>(blob.data()) < cmd_line["in"].data()
+         && cmd_line["in"].data() < reinterpret_cast<const char*>(blob.data() + blob.size());
+
+      // A worker maps the blob from a memfd.
+      //
+      auto mapped = true;
+#if defined(__linux__)
+      const auto fd = slx::make_command_line_blob_fd(blob, /*close_on_exec:*/ true);
+      slx::mapped_file mapping;
+      mapped = fd >= 0 && mapping.open(fd);
+      const slx::command_line_blob worker(mapping.view());
+      mapped = mapped && worker && "file.json" == worker["in"] && "64" == worker["threads"];
+      if (fd >= 0) ::close(fd);
+#endif
+
+      // Corrupted and truncated blobs are rejected.
+      //
+      auto corrupted = blob;
+      if (!corrupted.empty()) corrupted.back() ^= std::byte{1};
+      auto every_byte_checked = true;
+      for (auto i = sizeof(slx::detail::blob_header_); i < blob.size(); ++i) {
+         auto flipped = blob;
+         flipped[i] ^= std::byte{0x10};
+         every_byte_checked = every_byte_checked && !slx::command_line_blob(flipped);
+      }
+      const auto validated =
+         !slx::command_line_blob(corrupted)
+         && !slx::command_line_blob(std::span<const std::byte>(blob.data(), blob.size() - 1))
+         && slx::command_line_blob(corrupted).empty() && every_byte_checked;
+
+      // A worker publishes the blob as its global results.
+      //
+      slx::clear_command_line_options();
+      const auto published =
+         !slx::publish_command_line_blob(slx::command_line_blob(corrupted))
+         && !slx::command_line_option("in")
+         && slx::publish_command_line_blob(cmd_line)
+         && "file.json" == slx::get_command_line_option("in") && slx::command_line_option("out")
+         && "64" == slx::command_line_snapshot()->at("threads") && results.size() == slx::command_line_snapshot()->size();
+      slx::clear_command_line_options();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Serialized results should be queried in place and validated."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(in_place).value_
+         && expect(mapped).value_
+         && expect(validated).value_
+         && expect(published).value_;
+#else
+      create_log_report_result("Serialized results should be queried in place and validated.");
+      g_test_results.back().succeeded = in_place && mapped && validated && published;
+#endif
+   };
+}
+
+void test_with_streamed_tokens()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Streamed tokens should produce the same options as a full parse."_test = [&]
+#endif
+   {
+      constexpr auto schema = slx::make_command_line_schema({
+         {"in", "i", true}, {"out", "o", false}, {"verbose", "v", false},
+         {"inputs", "", false, {}, {}, slx::option_arity::multiple} });
+
+      const std::array<std::string_view, 11> tokens{
+         "app.exe", "--in", "\"file.json\"", "-v", "--unknown", "--inputs", "a", "b", "-o", "out", "--verbose" };
+
+      // Each token is copied into a buffer that is overwritten by the next one, as a reader of
+      // a pipe would; the session never refers to earlier tokens.
+      //
+      std::vector<std::pair<std::size_t, std::string>> events;
+      const auto emit = [&](const std::size_t option, const std::string_view value) {
+         events.emplace_back(option, std::string(value));
+      };
+      slx::command_line_stream session(schema);
+      std::string buffer;
+      for (std::size_t i = 1; i < tokens.size(); ++i) {
+         buffer.assign(tokens[i]);
+         session.feed(buffer, emit);
+      }
+      const auto finished = session.finish(emit);
+
+      const std::vector<std::pair<std::size_t, std::string>> expected{
+         {0, "file.json"}, {2, ""}, {3, "a"}, {3, "b"}, {1, "out"}, {2, ""} };
+
+      std::array<char*, tokens.size()> argv{};
+      std::vector<std::string> storage(tokens.begin(), tokens.end());
+      for (std::size_t i = 0; i < tokens.size(); ++i) argv[i] = storage[i].data();
+      const auto views = slx::parse_command_line_views(schema, static_cast<int>(argv.size()), argv.data(), display_help);
+
+      const auto streamed =
+         finished && expected == events
+         && views["in"] == events[0].second && views["out"] == events[4].second && views.contains("verbose")
+         && sizeof(session) <= 2 * sizeof(void*) + sizeof(slx::detail::option_bitset_);
+
+      // The next command line starts afresh; a missing required option fails finish.
+      //
+      events.clear();
+      session.feed("-o", emit);
+      const auto missing = !session.finish(emit) && session.missing(0) && !session.missing(1)
+                           && 1 == events.size() && 1 == events[0].first && events[0].second.empty();
+
+      // Joined values, bundled flags, negative numbers and '--' are split as by a full parse.
+      //
+      constexpr auto joined_schema = slx::make_command_line_schema({
+         {"threads", "j", false}, {"extract", "x", false}, {"verbose", "v", false}, {"file", "f", false},
+         {"offset", "", false}, {"label", "", false} });
+
+      const std::array<std::string_view, 10> joined_tokens{
+         "app.exe", "--threads=64", "-xvf", "archive.tar", "--offset", "-5", "-j8", "--", "--label", "text" };
+
+      events.clear();
+      slx::command_line_stream joined_session(joined_schema);
+      for (std::size_t i = 1; i < joined_tokens.size(); ++i) {
+         buffer.assign(joined_tokens[i]);
+         joined_session.feed(buffer, emit);
+      }
+      const auto joined_finished = joined_session.finish(emit);
+
+      const std::vector<std::pair<std::size_t, std::string>> joined_expected{
+         {0, "64"}, {1, ""}, {2, ""}, {3, "archive.tar"}, {4, "-5"}, {0, "8"} };
+
+      std::array<char*, joined_tokens.size()> joined_argv{};
+      std::vector<std::string> joined_storage(joined_tokens.begin(), joined_tokens.end());
+      for (std::size_t i = 0; i < joined_tokens.size(); ++i) joined_argv[i] = joined_storage[i].data();
+      const auto joined_views = slx::parse_command_line_views(joined_schema, static_cast<int>(joined_argv.size()),
+                                                              joined_argv.data(), display_help);
+
+      const auto joined =
+         joined_finished && joined_expected == events
+         && "8" == joined_views["threads"] && "archive.tar" == joined_views["file"] && "-5" == joined_views["offset"]
+         && joined_views.contains("extract") && joined_views.contains("verbose") && !joined_views.contains("label");
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Streamed tokens should produce the same options as a full parse."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(streamed).value_
+         && expect(missing).value_
+         && expect(joined).value_;
+#else
+      create_log_report_result("Streamed tokens should produce the same options as a full parse.");
+      g_test_results.back().succeeded = streamed && missing && joined;
+#endif
+   };
+}
+
+void test_with_every_missing_option()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Every missing required option should be reported by one parse."_test = [&]
+#endif
+   {
+      // 300 options (more than the inline words of the presence bitset); every 50th is required
+      // and 'option-100' is the only required one on the command line.
+      //
+      slx::command_line_options_t options;
+      for (auto i = 0; i < 300; ++i) options.emplace_back(fmt::format("option-{}", i), "", 0 == i % 50);
+
+      constexpr int argc{ 3 };
+      const char* argv_[argc] = { "app.exe", "--option-100", "value" };
+      const auto argv = const_cast<char**>(argv_);
+      auto helps = 0;
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, argc, argv, [&] { ++helps; });
+
+      const std::vector<std::string> expected{ "option-0", "option-50", "option-150", "option-200", "option-250" };
+      const auto runtime = 1 == helps && expected == context.missing_options();
+
+      // The schema's required mask spans two words.
+      //
+      constexpr auto schema = slx::make_command_line_schema({
+         {"a", "", true}, {"b", "", false}, {"c", "", true}, {"d", "", false}, {"e", "", false}, {"f", "", false},
+         {"g", "", false}, {"h", "", false}, {"i", "", false}, {"j", "", false}, {"k", "", false}, {"l", "", false},
+         {"m", "", false}, {"n", "", false}, {"o", "", false}, {"p", "", false}, {"q", "", false}, {"r", "", false},
+         {"s", "", false}, {"t", "", false}, {"u", "", false}, {"v", "", false}, {"w", "", false}, {"x", "", false},
+         {"y", "", false}, {"z", "", false}, {"aa", "", false}, {"ab", "", false}, {"ac", "", false}, {"ad", "", false},
+         {"ae", "", false}, {"af", "", false}, {"ag", "", false}, {"ah", "", false}, {"ai", "", false}, {"aj", "", false},
+         {"ak", "", false}, {"al", "", false}, {"am", "", false}, {"an", "", false}, {"ao", "", false}, {"ap", "", false},
+         {"aq", "", false}, {"ar", "", false}, {"as", "", false}, {"at", "", false}, {"au", "", false}, {"av", "", false},
+         {"aw", "", false}, {"ax", "", false}, {"ay", "", false}, {"az", "", false}, {"ba", "", false}, {"bb", "", false},
+         {"bc", "", false}, {"bd", "", false}, {"be", "", false}, {"bf", "", false}, {"bg", "", false}, {"bh", "", false},
+         {"bi", "", false}, {"bj", "", false}, {"bk", "", false}, {"bl", "", false}, {"bm", "", true}, {"bn", "", true} });
+
+      constexpr int schema_argc{ 2 };
+      const char* schema_argv_[schema_argc] = { "app.exe", "--bm" };
+      slx::parse_command_line_args(context, schema, schema_argc, const_cast<char**>(schema_argv_), [&] { ++helps; });
+      const auto with_schema =
+         2 == helps && std::vector<std::string>{ "a", "c", "bn" } == context.missing_options()
+         && 2 == schema.required_mask().size();
+
+      slx::parse_command_line_args(options, argc, argv, nullptr);
+      const auto global = expected == slx::get_missing_command_line_options();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Every missing required option should be reported by one parse."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(runtime).value_
+         && expect(with_schema).value_
+         && expect(global).value_;
+#else
+      create_log_report_result("Every missing required option should be reported by one parse.");
+      g_test_results.back().succeeded = runtime && with_schema && global;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
+void test_with_unknown_option_suggestions()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "A strict parse should report unknown options with the closest registered name."_test = [&]
+#endif
+   {
+      slx::command_line_options_t options{ {"threads", "j", false}, {"output", "o", false}, {"verbose", "v", false} };
+
+      constexpr int argc{ 8 };
+      const char* argv_[argc] = { "app.exe", "--thread", "64", "--outptu", "out.txt", "-x", "--verbose", "--" };
+      const auto argv = const_cast<char**>(argv_);
+      auto helps = 0;
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, argc, argv, [&] { ++helps; },
+                                   slx::parse_mode::strict);
+
+      const auto& unknown = context.unknown_options();
+      const auto strict =
+         1 == helps && 3 == unknown.size()
+         && "--thread" == unknown[0].token && "--threads" == unknown[0].suggestion
+         && "--outptu" == unknown[1].token && "--output" == unknown[1].suggestion
+         && "-x" == unknown[2].token && unknown[2].suggestion.empty()
+         && context.has_option("verbose");
+
+      // Without strict mode unknown options are ignored, as before.
+      //
+      slx::parse_command_line_args(context, options, argc, argv, [&] { ++helps; });
+      const auto lenient = 1 == helps && context.unknown_options().empty();
+
+      // 10k registered names; only the closest one is suggested.
+      //
+      slx::command_line_options_t many;
+      for (auto i = 0; i < 10000; ++i) many.emplace_back(fmt::format("option-{}", i), "", false);
+      many.emplace_back("compression-level", "", false);
+      const auto long_name = std::string(70, 'a') + "-level";
+      many.emplace_back(long_name, "", false);
+      const auto large =
+         "--compression-level" == slx::suggest_command_line_option(many, "--compresion-levl")
+         && "--" + long_name == slx::suggest_command_line_option(many, "--" + std::string(70, 'a') + "-levl")
+         && "--option-1234" == slx::suggest_command_line_option(many, "--option-1234x")
+         && slx::suggest_command_line_option(many, "--unrelated-name").empty();
+
+      constexpr auto schema = slx::make_command_line_schema({ {"threads", "j", false}, {"output", "o", false} });
+      const auto with_schema = "--threads" == slx::suggest_command_line_option(schema, "--thraeds");
+
+      // The views and lists have nowhere to report unknown options, so they refuse the mode.
+      //
+      auto views_refused = false;
+      auto lists_refused = false;
+      try { (void)slx::parse_command_line_views(schema, argc, argv, nullptr, slx::parse_mode::strict); }
+      catch (const std::invalid_argument&) { views_refused = true; }
+      slx::command_line_lists lists;
+      try { slx::parse_command_line_lists(lists, options, argc, argv, nullptr, slx::parse_mode::abbreviations); }
+      catch (const std::invalid_argument&) { lists_refused = true; }
+      const auto refused = views_refused && lists_refused;
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("A strict parse should report unknown options with the closest registered name."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(strict).value_
+         && expect(lenient).value_
+         && expect(large).value_
+         && expect(with_schema).value_
+         && expect(refused).value_;
+#else
+      create_log_report_result("A strict parse should report unknown options with the closest registered name.");
+      g_test_results.back().succeeded = strict && lenient && large && with_schema && refused;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
+// A parse from the initializer of a global: the opt-in headers, included ahead of it, have
+// registered their modes already (see slx::parse_mode).
+//
+static const bool g_abbreviated_during_static_initialization = [] {
+   const slx::command_line_options_t options{ {"enable-vectorized-io", "", false} };
+   const char* argv_[2] = { "app.exe", "--enable-vec" };
+   slx::parser_context context;
+   slx::parse_command_line_args(context, options, 2, const_cast<char**>(argv_), nullptr, slx::parse_mode::abbreviations);
+   return context.has_option("enable-vectorized-io");
+}();
+
+void test_with_abbreviations()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Unambiguous prefixes should abbreviate long options, also through a mapped completion index."_test = [&]
+#endif
+   {
+      slx::command_line_options_t options{ {"enable-vectorized-io", "", false}, {"enable-verbose-log", "", false},
+                                           {"disable-vectorized-io", "", false}, {"threads", "j", false} };
+
+      constexpr int argc{ 6 };
+      const char* argv_[argc] = { "app.exe", "--enable-vec", "--disable", "--enable-ve", "--thr", "8" };
+      const auto argv = const_cast<char**>(argv_);
+      auto helps = 0;
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, argc, argv, [&] { ++helps; },
+                                   slx::parse_mode::abbreviations | slx::parse_mode::strict);
+
+      const auto& ambiguous = context.ambiguous_options();
+      const auto parsed =
+         1 == helps && context.has_option("enable-vectorized-io") && context.has_option("disable-vectorized-io")
+         && "8" == context.option("threads") && !context.has_option("enable-verbose-log")
+         && context.unknown_options().empty() && 1 == ambiguous.size() && "--enable-ve" == ambiguous[0].token
+         && std::vector<std::string>{ "--enable-vectorized-io", "--enable-verbose-log" } == ambiguous[0].candidates
+         && 2 == ambiguous[0].candidate_count
+         && g_abbreviated_during_static_initialization;
+
+      // Without the mode abbreviations are not options.
+      //
+      slx::parse_command_line_args(context, options, argc, argv, nullptr);
+      const auto exact_only = 1 == context.args().size() && context.ambiguous_options().empty();
+
+      // The context keeps the index between parses; a table changed in place is reindexed.
+      //
+      slx::parse_command_line_args(context, options, argc, argv, nullptr, slx::parse_mode::abbreviations);
+      const auto reused = context.has_option("enable-vectorized-io") && 1 == context.ambiguous_options().size();
+      std::get<0>(options[0]) = "vectorized-io";
+      slx::parse_command_line_args(context, options, argc, argv, nullptr, slx::parse_mode::abbreviations);
+      const auto reindexed =
+         context.has_option("enable-verbose-log") && !context.has_option("vectorized-io")
+         && context.ambiguous_options().empty();
+
+      // A completion helper maps the saved index instead of building the schema.
+      //
+      constexpr auto schema = slx::make_command_line_schema({
+         {"enable-vectorized-io", "", false}, {"enable-verbose-log", "", false}, {"disable-vectorized-io", "", false},
+         {"threads", "j", false}, {"", "x", false} });
+      const auto index_path = (std::filesystem::temp_directory_path() / "cpp-argv-parser-test.completions").string();
+      const auto saved = slx::command_line_completions(schema).save(index_path);
+
+      slx::mapped_file mapping;
+      mapping.open(index_path);
+      const slx::command_line_completions completions(mapping.view());
+      const auto [first, last] = completions.prefix_range("enable-");
+      const auto [none, none_end] = completions.prefix_range("zzz");
+      const auto mapped =
+         saved && completions && 4 == completions.size() && 2 == last - first
+         && "enable-vectorized-io" == completions.name(first) && "enable-verbose-log" == completions.name(first + 1)
+         && none == none_end && 2 == completions.resolve("dis") && 3 == completions.resolve("threads")
+         && slx::command_line_completions::npos == completions.resolve("enable-v")
+         && !slx::command_line_completions(std::string_view("not an index"));
+      mapping.close();
+      std::filesystem::remove(index_path);
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Unambiguous prefixes should abbreviate long options, also through a mapped completion index."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(parsed).value_
+         && expect(exact_only).value_
+         && expect(reused && reindexed).value_
+         && expect(mapped).value_;
+#else
+      create_log_report_result("Unambiguous prefixes should abbreviate long options, also through a mapped completion index.");
+      g_test_results.back().succeeded = parsed && exact_only && reused && reindexed && mapped;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
+void test_with_joined_and_bundled_options()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Joined values, bundled flags, negative numbers and '--' should be recognized."_test = [&]
+#endif
+   {
+      slx::command_line_options_t options{ {"threads", "j", false}, {"extract", "x", false}, {"verbose", "v", false},
+                                           {"file", "f", false}, {"offset", "", false}, {"name", "", false},
+                                           {"label", "", false} };
+
+      constexpr int argc{ 11 };
+      const char* argv_[argc] = { "app.exe", "--threads=64", "-xvf", "archive.tar", "--offset", "-5",
+                                  "--name=\"a b\"", "--", "--label", "text", "-j8" };
+      slx::parser_context context;
+      slx::parse_command_line_args(context, options, argc, const_cast<char**>(argv_), nullptr);
+      const auto joined =
+         "64" == context.option("threads") && context.has_option("extract") && context.option("extract").empty()
+         && context.has_option("verbose") && "archive.tar" == context.option("file") && "-5" == context.option("offset")
+         && "a b" == context.option("name") && !context.has_option("label");
+
+      constexpr int attached_argc{ 3 };
+      const char* attached_argv_[attached_argc] = { "app.exe", "-j8", "-xq" };
+      slx::parse_command_line_args(context, options, attached_argc, const_cast<char**>(attached_argv_), nullptr);
+      const auto attached = "8" == context.option("threads") && "q" == context.option("extract");
+
+      // A table large enough to switch from the linear search to the hash index part way through.
+      //
+      slx::command_line_options_t many;
+      for (auto i = 0; i < 40; ++i) many.emplace_back(fmt::format("option-{}", i), fmt::format("o{}", i), false);
+      many.emplace_back("option-7", "", false);
+      std::vector<std::string> tokens{ "app.exe" };
+      for (auto i = 0; i < 40; ++i) {
+         tokens.push_back(0 == i % 2 ? fmt::format("--option-{}={}", i, i) : fmt::format("-o{}", i));
+         if (0 != i % 2) tokens.push_back(std::to_string(-i));
+      }
+      std::vector<char*> many_argv;
+      for (auto& token : tokens) many_argv.push_back(token.data());
+      slx::parse_command_line_args(context, many, static_cast<int>(many_argv.size()), many_argv.data(), nullptr);
+      auto indexed = 40 == context.args().size() - 1;
+      for (auto i = 0; i < 40; ++i) indexed = indexed && std::to_string(0 == i % 2 ? i : -i) == context.option(fmt::format("option-{}", i));
+
+      constexpr auto schema = slx::make_command_line_schema({ {"level", "l", false, slx::option_type::integer},
+                                                              {"threads", "j", false, slx::option_type::integer} });
+      constexpr int schema_argc{ 4 };
+      const char* schema_argv_[schema_argc] = { "app.exe", "--level", "-3", "-j4" };
+      const auto views = slx::parse_command_line_views(schema, schema_argc, const_cast<char**>(schema_argv_), nullptr);
+      const auto with_schema = !views.has_errors() && -3 == views.get<int>("level") && 4 == views.get<int>("threads");
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Joined values, bundled flags, negative numbers and '--' should be recognized."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(joined).value_
+         && expect(attached).value_
+         && expect(indexed).value_
+         && expect(with_schema).value_;
+#else
+      create_log_report_result("Joined values, bundled flags, negative numbers and '--' should be recognized.");
+      g_test_results.back().succeeded = joined && attached && indexed && with_schema;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
+void test_with_deferred_process_parse()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "A deferred parse of the process command line should run once, on first access."_test = [&]
+#endif
+   {
+      slx::clear_command_line_options();
+
+      const auto& process = slx::process_command_line::current();
+      const auto read = process.argc() >= 1 && !process[0].empty() && nullptr == process.argv()[process.argc()];
+
+      // No argc/argv plumbing: the options are registered and the parse runs when the results
+      // are first read, on any thread.
+      //
+      // The options are copied into the registration, so they need not outlive it.
+      //
+      std::atomic<int> helps = 0;
+      {
+         slx::command_line_options_t options{ {"deferred-test-option", "", true} };
+         slx::defer_command_line_parse(options, [&] { ++helps; });
+      }
+      const auto deferred = 0 == helps;
+
+      std::vector<std::thread> readers;
+      std::atomic<int> agreed = 0;
+      for (auto i = 0; i < 4; ++i) {
+         readers.emplace_back([&] {
+            if (slx::get_command_line_option("app") == process[0]) ++agreed;
+         });
+      }
+      for (auto& reader : readers) reader.join();
+      const auto once =
+         1 == helps && 4 == agreed && !slx::command_line_option("deferred-test-option")
+         && std::vector<std::string>{ "deferred-test-option" } == slx::get_missing_command_line_options()
+         && process[0] == slx::command_line_snapshot()->at("app") && 1 == helps;
+
+      // A snapshot lookup returns a view of the published value instead of a copy.
+      //
+      const auto snapshot = slx::command_line_snapshot();
+      const auto app = slx::get_command_line_option(snapshot, "app");
+      const auto zero_copy =
+         app.data() == snapshot->at("app").data() && slx::command_line_option(snapshot, "app")
+         && slx::get_command_line_option(snapshot, "deferred-test-option").empty();
+
+      // A deferred parse that throws (here, from its help function) does not escape the
+      // noexcept get_command_line_option; later accesses see the results as they were.
+      //
+      slx::defer_command_line_parse({ {"deferred-throwing-option", "", true} },
+                                    [] { throw std::runtime_error("no help"); });
+      const bool contained =
+         slx::get_command_line_option("app").empty() && process[0] == slx::get_command_line_option("app");
+
+      // Nor does it escape the noexcept accessors of the diagnostics, which report the parse as
+      // far as it got.
+      //
+      slx::defer_command_line_parse({ {"deferred-throwing-missing", "", true} },
+                                    [] { throw std::runtime_error("no help"); });
+      const bool reported =
+         std::vector<std::string>{ "deferred-throwing-missing" } == slx::get_missing_command_line_options()
+         && slx::get_unknown_command_line_options().empty() && slx::get_ambiguous_command_line_options().empty();
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("A deferred parse of the process command line should run once, on first access."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(read).value_
+         && expect(deferred).value_
+         && expect(once).value_
+         && expect(zero_copy).value_
+         && expect(contained).value_
+         && expect(reported).value_;
+#else
+      create_log_report_result("A deferred parse of the process command line should run once, on first access.");
+      g_test_results.back().succeeded = read && deferred && once && zero_copy && contained && reported;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
+void test_with_instrumentation()
+{
+#ifdef ENABLE_BOOST_UT_MODULE
+   using namespace boost::ut;
+   "Instrumented parses and lookups should be counted on every thread."_test = [&]
+#endif
+   {
+      slx::clear_command_line_options();
+      const auto before = slx::command_line_metrics();
+
+      // The parse runs on a thread that exits before the snapshot, the lookups on this one.
+      //
+      static slx::command_line_options_t options{ {"metrics-threads", "j", false}, {"metrics-verbose", "v", false} };
+      std::thread([] {
+         std::vector<char*> argv{ const_cast<char*>("mock.app"), const_cast<char*>("-j"), const_cast<char*>("8"),
+                                  const_cast<char*>("--metrics-verbose"), nullptr };
+         slx::parse_command_line_args(options, 4, argv.data(), nullptr);
+      }).join();
+      auto found = 0;
+      for (auto i = 0; i < 3; ++i) found += "8" == slx::get_command_line_option("metrics-threads") ? 1 : 0;
+      found += slx::command_line_option("metrics-verbose") ? 1 : 0;
+
+      const auto after = slx::command_line_metrics();
+      const auto key_lookups = [&](const slx::command_line_metrics_t& metrics, const std::string_view key) {
+         const auto it = std::find_if(metrics.keys.begin(), metrics.keys.end(), [&](const auto& k) { return key == k.key; });
+         return it != metrics.keys.end() ? it->lookups : 0;
+      };
+
+      const auto parsed = 4 == found;
+      const auto counted = !slx::command_line_instrumentation
+         ? 0 == after.parses && 0 == after.lookups && after.keys.empty()
+         : 1 == after.parses - before.parses && 3 == after.tokens_scanned - before.tokens_scanned
+           && after.name_comparisons - before.name_comparisons >= 2 && 4 == after.lookups - before.lookups
+           && 3 == key_lookups(after, "metrics-threads") - key_lookups(before, "metrics-threads")
+           && 1 == key_lookups(after, "metrics-verbose") - key_lookups(before, "metrics-verbose")
+           && after.allocations - before.allocations >= 2;
+
+#ifdef ENABLE_BOOST_UT_MODULE
+      create_log_report_result("Instrumented parses and lookups should be counted on every thread."_test.name);
+
+      g_test_results.back().succeeded =
+         expect(parsed).value_
+         && expect(counted).value_;
+#else
+      create_log_report_result("Instrumented parses and lookups should be counted on every thread.");
+      g_test_results.back().succeeded = parsed && counted;
+#endif
+      slx::clear_command_line_options();
+   };
+}
+
 // Misc. Support Functions.
 //
 inline std::string create_msg(const std::string_view msg, bool success)
@@ -21,8 +21,13 @@
 // -----------------------------------------------------------------------------------------
 
 #include <array>
+#include <atomic>
+#include <filesystem>
 #include <fstream>
+#include <memory>
+#include <new>
 #include <set>
+#include <stdexcept>
 #include <cstdlib>
 #include <chrono>
 #include <fmt/format.h>
@@ -38,6 +43,21 @@
 #endif
 
 #include <slx/cmd-line-parsing.hh>
+#include <slx/cmd-line-schema.hh>
+#include <slx/cmd-line-views.hh>
+#include <slx/cmd-line-batch.hh>
+#include <slx/cmd-line-binding.hh>
+#include <slx/cmd-line-response-files.hh>
+#include <slx/cmd-line-suggestions.hh>
+#include <slx/cmd-line-lists.hh>
+#include <slx/cmd-line-resolver.hh>
+#include <slx/cmd-line-tokenizer.hh>
+#include <slx/cmd-line-subcommands.hh>
+#include <slx/cmd-line-blob.hh>
+#include <slx/cmd-line-stream.hh>
+#include <slx/cmd-line-completions.hh>
+#include <slx/cmd-line-process.hh>
+#include <slx/cmd-line-instrumentation.hh>
 
 // A data model used for mark down log file output.
 //